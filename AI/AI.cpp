@@ -31,7 +31,6 @@ AIClass::AIClass()
 		AIChannelsOverride[a]=255;
 	}
 	StreamDelay=300;
-	AImillis=millis();
 }
 
 byte AIClass::GetChannel(byte Channel)
@@ -32,7 +32,6 @@ public:
 	byte AIChannels[AI_CHANNELS];
 	byte AIChannelsOverride[AI_CHANNELS];
 	int StreamDelay;
-	unsigned long AImillis;
 	void SetPort(byte portnum);
 	void inline SetChannel(byte Channel, byte Value) { if (Channel<AI_CHANNELS) AIChannels[Channel]=Value; };
 	void inline SetChannelOverride(byte Channel, byte Value) { if (Value>100) Value=255; if (Channel<AI_CHANNELS) AIChannelsOverride[Channel]=Value; };
@@ -115,17 +115,12 @@ int EthernetClient::noblockconnect(IPAddress ip, uint16_t port) {
 
 int EthernetClient::checkconnect() {
   int s=status();
-  if (s != SnSR::ESTABLISHED) {
   if (s == SnSR::CLOSED) {
     _sock = MAX_SOCK_NUM;
     stop();
     return 0;
   }
-  }
-  else
-  {
   return s;
-  }
 }
 
 size_t EthernetClient::write(uint8_t b) {
@@ -152,6 +152,9 @@ uint8_t W5100Class::write(uint16_t _addr, uint8_t _data)
   return 1;
 }
 
+// The W5100 SPI interface has no burst mode: every byte is its own
+// opcode/address/data frame and SS must go high between frames, so the
+// bulk transfers below cannot be collapsed into one transaction.
 uint16_t W5100Class::write(uint16_t _addr, const uint8_t *_buf, uint16_t _len)
 {
   for (uint16_t i=0; i<_len; i++)
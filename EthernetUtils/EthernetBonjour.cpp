@@ -306,6 +306,8 @@ int EthernetBonjourClass::_closeMDNSSession()
       ethernet_compat_close(this->_socket);
 
    this->_socket = -1;
+
+   return 1;
 }
 
 // return value:
@@ -171,6 +171,8 @@ int EthernetDHCPClass::_closeDHCPSession()
       ethernet_compat_close(this->_socket);
    
    this->_socket = -1;
+   
+   return 1;
 }
 
 void EthernetDHCPClass::_resetDHCP()
@@ -129,6 +129,8 @@ int EthernetDNSClass::_closeDNSSession()
       ethernet_compat_close(this->_socket);
 
    this->_socket = -1;
+
+   return 1;
 }
 
 // return value:
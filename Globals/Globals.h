@@ -164,6 +164,7 @@ const char NoIMCheck1[] PROGMEM = "Found";
 
 // Relay Box Modules
 #define MAX_RELAY_EXPANSION_MODULES     8
+#define RELAY_REFRESH_INTERVAL			1000  // unchanged relay boxes are rewritten this often (ms)
 #define PWM_EXPANSION_CHANNELS     		6
 #define SIXTEENCH_PWM_EXPANSION_CHANNELS     		16
 #define IO_EXPANSION_CHANNELS     		6
@@ -361,7 +362,6 @@ static byte RANetSeq, RANetCRC;
 static byte RANetTrigger, TriggerValue;
 static byte RANetData[RANET_SIZE];
 static byte RANetStatus[RANET_SIZE];
-static unsigned long RANetlastmillis;
 
 #ifdef RA_STAR
 #define RANET_SERIAL	Serial2
@@ -1267,6 +1267,13 @@ typedef struct Compensation
 #define CALIBRATION_TIMER				3
 
 // Cloud
+#define CLOUD_FRAME_SIZE	64  // bytes of CLOUD: lines sent to the wifi attachment per cycle
+// #define CLOUD_BATCH sends them as one comma separated frame, the attachment must support it
+#define STATUS_RECORD_VERSION	1  // layout version of the binary status record
+// Consumers of the cloud parameter registry, each keeps its own view of what changed
+#define PARAM_CLOUD		0
+#define PARAM_EVENTS	1
+#define PARAM_CONSUMERS	2
 #define MQTT_NONE	0
 #define MQTT_REQUESTALL	1
 #define MQTT_T	2
@@ -1317,6 +1324,8 @@ typedef struct Compensation
 #define MQTT_CALCUS8 47
 #define MQTT_CO2 48
 #define MQTT_CO2HUM 49
+#define MQTT_PROFILER 50
+#define MQTT_BINARY 51
 
 
 // Cloud Expansion Bits ( CEM )
@@ -1335,7 +1344,11 @@ typedef struct Compensation
 #define CloudCo2Bit 3
 
 #if defined RA_STAR || defined CLOUD_WIFI
+byte MQTTLookup(const char *token);  // MQTT_ type of a cloud command token, MQTT_NONE if unknown
 void MQTTSubCallback(char* topic, byte* payload, unsigned int length);
+#ifdef RA_STAR
+void MQTTTopicCallback(char* topic, byte* payload, unsigned int length);
+#endif // RA_STAR
 #endif // RA_STAR
 
 #if defined RA_TOUCH || defined RA_TOUCHDISPLAY || defined RA_EVOLUTION || defined RA_STAR
@@ -1619,6 +1632,40 @@ static PROGMEM const char * const menu_button_items6[] = {MENU_BUTTON_CEXP5, MEN
 #else 
 	#define Co2bit 0
 #endif
+// Refresh() profiler stages
+#define PROFILE_DCPUMP		0
+#define PROFILE_PWM			1
+#define PROFILE_TOUCH		2
+#define PROFILE_RFAI		3
+#define PROFILE_EXPANSION	4
+#define PROFILE_RELAY		5
+#define PROFILE_NETWORK		6
+#define PROFILE_SCHEDULER	7
+#define PROFILE_RECEIVE		8
+#define PROFILE_TEMP		9
+#define PROFILE_ANALOG		10
+#define PROFILE_SENSORS		11
+// Cloud path, timed per message rather than per Refresh()
+#define PROFILE_COMMAND		12  // one inbound cloud command through MQTTSubCallback
+#define PROFILE_PUBLISH		13  // one batch of changed parameters published
+#define PROFILE_STAGES		14
+#define PROFILE_WINDOW		256  // samples averaged per stage
+#ifndef PROFILE_BUDGET
+#define PROFILE_BUDGET		500000UL  // Refresh() longer than this (us) is counted as an overrun
+#endif  // PROFILE_BUDGET
+
+#ifdef REFRESH_PROFILER
+#define PROFILE_START()		Profiler.Start()
+#define PROFILE_MARK(stage)	Profiler.Mark(stage)
+#define PROFILE_END()		Profiler.End()
+#define PROFILE_SAMPLE(stage,start)	ReefAngel.Profiler.Sample(stage,micros()-(start))
+#else
+#define PROFILE_START()
+#define PROFILE_MARK(stage)
+#define PROFILE_END()
+#define PROFILE_SAMPLE(stage,start)
+#endif  // REFRESH_PROFILER
+
 // Global macros
 #define SIZE(array) (sizeof(array) / sizeof(*array))
 // color definition
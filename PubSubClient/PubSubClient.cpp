@@ -10,40 +10,45 @@
 #include <avr/wdt.h>
 #endif // __AVR_ATmega2560__
 
+// readPacket() states
+#define MQTT_READ_HEADER 0
+#define MQTT_READ_LENGTH 1
+#define MQTT_READ_BODY   2
+
 PubSubClient::PubSubClient() {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     this->_client = NULL;
     this->stream = NULL;
     setCallback(NULL);
 }
 
 PubSubClient::PubSubClient(Client& client) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setClient(client);
     this->stream = NULL;
 }
 
 PubSubClient::PubSubClient(IPAddress addr, uint16_t port, Client& client) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(addr, port);
     setClient(client);
     this->stream = NULL;
 }
 PubSubClient::PubSubClient(IPAddress addr, uint16_t port, Client& client, Stream& stream) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(addr,port);
     setClient(client);
     setStream(stream);
 }
 PubSubClient::PubSubClient(IPAddress addr, uint16_t port, MQTT_CALLBACK_SIGNATURE, Client& client) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(addr, port);
     setCallback(callback);
     setClient(client);
     this->stream = NULL;
 }
 PubSubClient::PubSubClient(IPAddress addr, uint16_t port, MQTT_CALLBACK_SIGNATURE, Client& client, Stream& stream) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(addr,port);
     setCallback(callback);
     setClient(client);
@@ -51,26 +56,26 @@ PubSubClient::PubSubClient(IPAddress addr, uint16_t port, MQTT_CALLBACK_SIGNATUR
 }
 
 PubSubClient::PubSubClient(uint8_t *ip, uint16_t port, Client& client) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(ip, port);
     setClient(client);
     this->stream = NULL;
 }
 PubSubClient::PubSubClient(uint8_t *ip, uint16_t port, Client& client, Stream& stream) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(ip,port);
     setClient(client);
     setStream(stream);
 }
 PubSubClient::PubSubClient(uint8_t *ip, uint16_t port, MQTT_CALLBACK_SIGNATURE, Client& client) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(ip, port);
     setCallback(callback);
     setClient(client);
     this->stream = NULL;
 }
 PubSubClient::PubSubClient(uint8_t *ip, uint16_t port, MQTT_CALLBACK_SIGNATURE, Client& client, Stream& stream) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(ip,port);
     setCallback(callback);
     setClient(client);
@@ -78,32 +83,41 @@ PubSubClient::PubSubClient(uint8_t *ip, uint16_t port, MQTT_CALLBACK_SIGNATURE,
 }
 
 PubSubClient::PubSubClient(const char* domain, uint16_t port, Client& client) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(domain,port);
     setClient(client);
     this->stream = NULL;
 }
 PubSubClient::PubSubClient(const char* domain, uint16_t port, Client& client, Stream& stream) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(domain,port);
     setClient(client);
     setStream(stream);
 }
 PubSubClient::PubSubClient(const char* domain, uint16_t port, MQTT_CALLBACK_SIGNATURE, Client& client) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(domain,port);
     setCallback(callback);
     setClient(client);
     this->stream = NULL;
 }
 PubSubClient::PubSubClient(const char* domain, uint16_t port, MQTT_CALLBACK_SIGNATURE, Client& client, Stream& stream) {
-    this->_state = MQTT_DISCONNECTED;
+    init();
     setServer(domain,port);
     setCallback(callback);
     setClient(client);
     setStream(stream);
 }
 
+void PubSubClient::init() {
+    this->_state = MQTT_DISCONNECTED;
+    readState = MQTT_READ_HEADER;
+    routeCount = 0;
+    for (uint8_t i=0;i<MQTT_QUEUE_SIZE;i++) {
+        queue[i].topic = NULL;
+    }
+}
+
 boolean PubSubClient::connect(const char *id) {
     return connect(id,NULL,NULL,0,0,0,0);
 }
@@ -177,8 +191,11 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
             write(MQTTCONNECT,buffer,length-5);
 
             lastInActivity = lastOutActivity = millis();
+            readState = MQTT_READ_HEADER;
 
-            while (!_client->available()) {
+            uint8_t llen;
+            uint16_t len;
+            while ((len = readPacket(&llen)) == 0) {
 #ifdef __AVR_ATmega2560__
             	wdt_reset();
 #endif // __AVR_ATmega2560__
@@ -189,17 +206,23 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
                     return false;
                 }
             }
-            uint8_t llen;
-            uint16_t len = readPacket(&llen);
 
             if (len == 4) {
-                if (buffer[3] == 0) {
+                if (rxBuffer[3] == 0) {
                     lastInActivity = millis();
                     pingOutstanding = false;
                     _state = MQTT_CONNECTED;
+                    // Anything still queued goes out again as a fresh publish, with an
+                    // id from this connection so no PUBACK can match two entries
+                    for (uint8_t i=0;i<MQTT_QUEUE_SIZE;i++) {
+                        if (queue[i].topic) {
+                            queue[i].msgId = ++nextMsgId;
+                        }
+                        queue[i].tries = 0;
+                    }
                     return true;
                 } else {
-                    _state = buffer[3];
+                    _state = rxBuffer[3];
                 }
             }
             _client->stop();
@@ -211,84 +234,67 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
     return true;
 }
 
-// reads a byte into result
-boolean PubSubClient::readByte(uint8_t * result) {
-   uint32_t previousMillis = millis();
-   while(!_client->available()) {
-#ifdef __AVR_ATmega2560__
-	 wdt_reset();
-#endif // __AVR_ATmega2560__
-     uint32_t currentMillis = millis();
-     if(currentMillis - previousMillis >= ((int32_t) MQTT_SOCKET_TIMEOUT * 1000)){
-       return false;
-     }
-   }
-   *result = _client->read();
-   return true;
-}
-
-// reads a byte into result[*index] and increments index
-boolean PubSubClient::readByte(uint8_t * result, uint16_t * index){
-  uint16_t current_index = *index;
-  uint8_t * write_address = &(result[current_index]);
-  if(readByte(write_address)){
-    *index = current_index + 1;
-    return true;
-  }
-  return false;
-}
-
+// Consumes whatever bytes have arrived, up to the end of the current packet,
+// and returns right away. A partial packet is kept in readState/readPos and
+// resumed on the next call. Returns the packet length once it is complete,
+// 0 while more bytes are still to come or when the packet was ignored.
 uint16_t PubSubClient::readPacket(uint8_t* lengthLength) {
-    uint16_t len = 0;
-    if(!readByte(buffer, &len)) return 0;
-    bool isPublish = (buffer[0]&0xF0) == MQTTPUBLISH;
-    uint32_t multiplier = 1;
-    uint16_t length = 0;
-    uint8_t digit = 0;
-    uint16_t skip = 0;
-    uint8_t start = 0;
-
-    do {
-        if(!readByte(&digit)) return 0;
-        buffer[len++] = digit;
-        length += (digit & 127) * multiplier;
-        multiplier *= 128;
-#ifdef __AVR_ATmega2560__
-        wdt_reset();
-#endif // __AVR_ATmega2560__
-    } while ((digit & 128) != 0);
-    *lengthLength = len-1;
-
-    if (isPublish) {
-        // Read in topic length to calculate bytes to skip over for Stream writing
-        if(!readByte(buffer, &len)) return 0;
-        if(!readByte(buffer, &len)) return 0;
-        skip = (buffer[*lengthLength+1]<<8)+buffer[*lengthLength+2];
-        start = 2;
-        if (buffer[0]&MQTTQOS1) {
-            // skip message id
-            skip += 2;
+    while (_client->available()) {
+        uint8_t digit = _client->read();
+        readActivity = millis();
+        if (readState == MQTT_READ_HEADER) {
+            rxBuffer[0] = digit;
+            readPos = 1;
+            readLength = 0;
+            readMultiplier = 1;
+            readSkip = 0;
+            readState = MQTT_READ_LENGTH;
+            continue;
         }
-    }
-
-    for (uint16_t i = start;i<length;i++) {
-        if(!readByte(&digit)) return 0;
-        if (this->stream) {
-            if (isPublish && len-*lengthLength-2>skip) {
+        if (readState == MQTT_READ_LENGTH) {
+            rxBuffer[readPos++] = digit;
+            readLength += (digit & 127) * readMultiplier;
+            readMultiplier *= 128;
+            if ((digit & 128) != 0) continue;
+            readLengthLength = readPos-1;
+            // From here on readLength is the size of the whole packet
+            readLength += readPos;
+            readState = MQTT_READ_BODY;
+        } else {
+            bool isPublish = (rxBuffer[0]&0xF0) == MQTTPUBLISH;
+            uint16_t offset = readPos-readLengthLength-1;
+            if (this->stream && isPublish && offset >= 2 && readPos-readLengthLength-2>readSkip) {
                 this->stream->write(digit);
             }
+            if (readPos < MQTT_MAX_PACKET_SIZE) {
+                rxBuffer[readPos] = digit;
+            }
+            readPos++;
+            if (isPublish && offset == 1) {
+                // Topic length is in, work out the bytes to skip over for Stream writing
+                readSkip = (rxBuffer[readLengthLength+1]<<8)+rxBuffer[readLengthLength+2];
+                if (rxBuffer[0]&MQTTQOS1) {
+                    // skip message id
+                    readSkip += 2;
+                }
+            }
         }
-        if (len < MQTT_MAX_PACKET_SIZE) {
-            buffer[len] = digit;
+        if (readPos == readLength) {
+            readState = MQTT_READ_HEADER;
+            *lengthLength = readLengthLength;
+            if (!this->stream && readPos > MQTT_MAX_PACKET_SIZE) {
+                return 0; // This will cause the packet to be ignored.
+            }
+            return readPos;
         }
-        len++;
     }
-
-    if (!this->stream && len > MQTT_MAX_PACKET_SIZE) {
-        len = 0; // This will cause the packet to be ignored.
+    if (readState != MQTT_READ_HEADER && millis()-readActivity >= ((int32_t) MQTT_SOCKET_TIMEOUT*1000UL)) {
+        // The rest of the packet never came, the stream can't be resynchronised
+        readState = MQTT_READ_HEADER;
+        _state = MQTT_CONNECTION_TIMEOUT;
+        _client->stop();
     }
-
-    return len;
+    return 0;
 }
 
 boolean PubSubClient::loop() {
@@ -308,47 +314,52 @@ boolean PubSubClient::loop() {
                 pingOutstanding = true;
             }
         }
-        if (_client->available()) {
-            uint8_t llen;
-            uint16_t len = readPacket(&llen);
+        uint8_t llen;
+        uint16_t len = readPacket(&llen);
+        if (len > 0) {
             uint16_t msgId = 0;
             uint8_t *payload;
-            if (len > 0) {
-                lastInActivity = t;
-                uint8_t type = buffer[0]&0xF0;
-                if (type == MQTTPUBLISH) {
-                    if (callback) {
-                        uint16_t tl = (buffer[llen+1]<<8)+buffer[llen+2]; /* topic length in bytes */
-                        memmove(buffer+llen+2,buffer+llen+3,tl); /* move topic inside buffer 1 byte to front */
-                        buffer[llen+2+tl] = 0; /* end the topic as a 'C' string with \x00 */
-                        char *topic = (char*) buffer+llen+2;
-                        // msgId only present for QOS>0
-                        if ((buffer[0]&0x06) == MQTTQOS1) {
-                            msgId = (buffer[llen+3+tl]<<8)+buffer[llen+3+tl+1];
-                            payload = buffer+llen+3+tl+2;
-                            callback(topic,payload,len-llen-3-tl-2);
-
-                            buffer[0] = MQTTPUBACK;
-                            buffer[1] = 2;
-                            buffer[2] = (msgId >> 8);
-                            buffer[3] = (msgId & 0xFF);
-                            _client->write(buffer,4);
-                            lastOutActivity = t;
-
-                        } else {
-                            payload = buffer+llen+3+tl;
-                            callback(topic,payload,len-llen-3-tl);
-                        }
+            lastInActivity = t;
+            uint8_t type = rxBuffer[0]&0xF0;
+            if (type == MQTTPUBLISH) {
+                uint8_t qos = rxBuffer[0]&0x06;
+                uint16_t tl = (rxBuffer[llen+1]<<8)+rxBuffer[llen+2]; /* topic length in bytes */
+                memmove(rxBuffer+llen+2,rxBuffer+llen+3,tl); /* move topic inside buffer 1 byte to front */
+                rxBuffer[llen+2+tl] = 0; /* end the topic as a 'C' string with \x00 */
+                char *topic = (char*) rxBuffer+llen+2;
+                // msgId only present for QOS>0
+                if (qos == MQTTQOS1) {
+                    msgId = (rxBuffer[llen+3+tl]<<8)+rxBuffer[llen+3+tl+1];
+                    payload = rxBuffer+llen+3+tl+2;
+                    dispatch(topic,payload,len-llen-3-tl-2);
+
+                    buffer[0] = MQTTPUBACK;
+                    buffer[1] = 2;
+                    buffer[2] = (msgId >> 8);
+                    buffer[3] = (msgId & 0xFF);
+                    _client->write(buffer,4);
+                    lastOutActivity = t;
+
+                } else {
+                    payload = rxBuffer+llen+3+tl;
+                    dispatch(topic,payload,len-llen-3-tl);
+                }
+            } else if (type == MQTTPINGREQ) {
+                buffer[0] = MQTTPINGRESP;
+                buffer[1] = 0;
+                _client->write(buffer,2);
+            } else if (type == MQTTPINGRESP) {
+                pingOutstanding = false;
+            } else if (type == MQTTPUBACK) {
+                msgId = (rxBuffer[2]<<8)+rxBuffer[3];
+                for (uint8_t i=0;i<MQTT_QUEUE_SIZE;i++) {
+                    if (queue[i].topic && queue[i].msgId == msgId) {
+                        queue[i].topic = NULL;
                     }
-                } else if (type == MQTTPINGREQ) {
-                    buffer[0] = MQTTPINGRESP;
-                    buffer[1] = 0;
-                    _client->write(buffer,2);
-                } else if (type == MQTTPINGRESP) {
-                    pingOutstanding = false;
                 }
             }
         }
+        serviceQueue();
         return true;
     }
     return false;
@@ -389,59 +400,147 @@ boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigne
 }
 
 boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
-    uint8_t llen = 0;
-    uint8_t digit;
-    unsigned int rc = 0;
-    uint16_t tlen;
-    unsigned int pos = 0;
-    unsigned int i;
-    uint8_t header;
-    unsigned int len;
+    if (!beginPublish(topic, plength, retained)) {
+        return false;
+    }
+    for (unsigned int i=0;i<plength;i++) {
+        write((uint8_t)pgm_read_byte_near(payload + i));
+    }
+    return endPublish();
+}
 
-    if (!connected()) {
+boolean PubSubClient::queuePublish(const char* topic, const char* payload) {
+    uint8_t plength = strlen(payload);
+    if (plength > MQTT_QUEUE_PAYLOAD || MQTT_MAX_PACKET_SIZE < 5 + 2+strlen(topic) + 2 + plength) {
         return false;
     }
+    uint8_t klength = 0;
+    while (klength < plength && payload[klength] != MQTT_QUEUE_KEY) {
+        klength++;
+    }
+    MQTTQueued* entry = NULL;
+    for (uint8_t i=0;i<MQTT_QUEUE_SIZE;i++) {
+        if (queue[i].topic == NULL) {
+            if (entry == NULL) entry = &queue[i];
+        } else if (strcmp(queue[i].topic,topic) == 0 && queue[i].length >= klength
+                && memcmp(queue[i].payload,payload,klength) == 0
+                && (klength == queue[i].length || queue[i].payload[klength] == MQTT_QUEUE_KEY)) {
+            // Newer value for the same key, the pending one is dropped
+            entry = &queue[i];
+            break;
+        }
+    }
+    if (entry == NULL) {
+        // Queue is full, the caller keeps the value and tries again later
+        return false;
+    }
+    nextMsgId++;
+    if (nextMsgId == 0) {
+        nextMsgId = 1;
+    }
+    entry->topic = topic;
+    entry->msgId = nextMsgId;
+    entry->tries = 0;
+    entry->length = plength;
+    memcpy(entry->payload,payload,plength);
+    if (connected()) {
+        sendQueued(entry);
+    }
+    return true;
+}
 
-    tlen = strlen(topic);
+boolean PubSubClient::sendQueued(MQTTQueued* entry) {
+    // Leave room in the buffer for header and variable length field
+    uint16_t length = 5;
+    length = writeString(entry->topic,buffer,length);
+    buffer[length++] = (entry->msgId >> 8);
+    buffer[length++] = (entry->msgId & 0xFF);
+    memcpy(buffer+length,entry->payload,entry->length);
+    length += entry->length;
+    uint8_t header = MQTTPUBLISH|MQTTQOS1;
+    if (entry->tries > 0) {
+        header |= 0x08; // DUP
+    }
+    if (entry->tries < 255) {
+        entry->tries++;
+    }
+    entry->sent = millis();
+    return write(header,buffer,length-5);
+}
+
+void PubSubClient::serviceQueue() {
+    // Sends what has not gone out on this connection and repeats unacknowledged publishes.
+    // Nothing is given up, an entry only leaves on its PUBACK or a newer value for its key.
+    unsigned long t = millis();
+    for (uint8_t i=0;i<MQTT_QUEUE_SIZE;i++) {
+        MQTTQueued* entry = &queue[i];
+        if (entry->topic == NULL) continue;
+        if (entry->tries == 0 || t - entry->sent > MQTT_QUEUE_RETRY) {
+            sendQueued(entry);
+        }
+    }
+}
 
-    header = MQTTPUBLISH;
+boolean PubSubClient::beginPublish(const char* topic, unsigned int plength, boolean retained) {
+    if (!connected()) {
+        return false;
+    }
+    if (MQTT_MAX_PACKET_SIZE < 5 + 2+strlen(topic)) {
+        // Topic too long
+        return false;
+    }
+    // Leave room in the buffer for header and variable length field
+    uint16_t length = 5;
+    length = writeString(topic,buffer,length);
+    uint8_t header = MQTTPUBLISH;
     if (retained) {
         header |= 1;
     }
-    buffer[pos++] = header;
-    len = plength + 2 + tlen;
-    do {
-        digit = len % 128;
-        len = len / 128;
-        if (len > 0) {
-            digit |= 0x80;
-        }
-        buffer[pos++] = digit;
-        llen++;
-#ifdef __AVR_ATmega2560__
-        wdt_reset();
-#endif // __AVR_ATmega2560__
-    } while(len>0);
+    uint8_t hlen = buildHeader(header,buffer,length-5+plength);
+    uint16_t rc = _client->write(buffer+(5-hlen),length-(5-hlen));
+    lastOutActivity = millis();
+    streamPos = 0;
+    streamOk = (rc == length-(5-hlen));
+    return streamOk;
+}
 
-    pos = writeString(topic,buffer,pos);
+boolean PubSubClient::flushStream() {
+    if (streamPos > 0) {
+        if (_client->write(buffer,streamPos) != streamPos) {
+            streamOk = false;
+        }
+        lastOutActivity = millis();
+        streamPos = 0;
+    }
+    return streamOk;
+}
 
-    rc += _client->write(buffer,pos);
+boolean PubSubClient::endPublish() {
+    return flushStream();
+}
 
-    for (i=0;i<plength;i++) {
-        rc += _client->write((char)pgm_read_byte_near(payload + i));
+size_t PubSubClient::write(uint8_t data) {
+    // Staged in buffer so the client isn't handed the payload one byte at a time
+    buffer[streamPos++] = data;
+    if (streamPos == MQTT_MAX_PACKET_SIZE) {
+        flushStream();
     }
+    return 1;
+}
 
-    lastOutActivity = millis();
-
-    return rc == tlen + 4 + plength;
+size_t PubSubClient::write(const uint8_t *data, size_t size) {
+    for (size_t i=0;i<size;i++) {
+        write(data[i]);
+    }
+    return size;
 }
 
-boolean PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
+uint8_t PubSubClient::buildHeader(uint8_t header, uint8_t* buf, uint16_t length) {
+    // Puts the fixed header right in front of buf[5], returns its size
     uint8_t lenBuf[4];
     uint8_t llen = 0;
     uint8_t digit;
     uint8_t pos = 0;
-    uint16_t rc;
     uint16_t len = length;
     do {
         digit = len % 128;
@@ -460,10 +559,16 @@ boolean PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
     for (int i=0;i<llen;i++) {
         buf[5-llen+i] = lenBuf[i];
     }
+    return llen+1;
+}
+
+boolean PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
+    uint16_t rc;
+    uint8_t hlen = buildHeader(header, buf, length);
 
 #ifdef MQTT_MAX_TRANSFER_SIZE
-    uint8_t* writeBuf = buf+(4-llen);
-    uint16_t bytesRemaining = length+1+llen;  //Match the length type
+    uint8_t* writeBuf = buf+(5-hlen);
+    uint16_t bytesRemaining = length+hlen;  //Match the length type
     uint8_t bytesToWrite;
     boolean result = true;
     while((bytesRemaining > 0) && result) {
@@ -478,12 +583,70 @@ boolean PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
     }
     return result;
 #else
-    rc = _client->write(buf+(4-llen),length+1+llen);
+    rc = _client->write(buf+(5-hlen),length+hlen);
     lastOutActivity = millis();
-    return (rc == 1+llen+length);
+    return (rc == hlen+length);
 #endif
 }
 
+boolean PubSubClient::route(const char* filter, MQTTRouteHandler handler) {
+    if (routeCount == MQTT_MAX_ROUTES) {
+        return false;
+    }
+    // Work out once what can be compared as a plain string
+    MQTTRoute* r = &routes[routeCount++];
+    r->filter = filter;
+    r->handler = handler;
+    r->prefix = 0;
+    while (filter[r->prefix] && filter[r->prefix] != '+' && filter[r->prefix] != '#') {
+        r->prefix++;
+    }
+    r->exact = (filter[r->prefix] == 0);
+    return true;
+}
+
+// Matches the part of a topic after a route's literal prefix
+static boolean topicMatches(const char* f, const char* t) {
+    while (*f) {
+        if (*f == '#') {
+            return true;
+        }
+        if (*f == '+') {
+            while (*t && *t != '/') t++;
+            f++;
+        } else if (*f == *t) {
+            f++;
+            t++;
+        } else {
+            // "a/#" also matches "a"
+            return (*t == 0 && f[0] == '/' && f[1] == '#' && f[2] == 0);
+        }
+    }
+    return *t == 0;
+}
+
+void PubSubClient::dispatch(char* topic, uint8_t* payload, unsigned int length) {
+    for (uint8_t i=0;i<routeCount;i++) {
+        MQTTRoute* r = &routes[i];
+        if (r->exact) {
+            if (strcmp(r->filter,topic) != 0) continue;
+        } else {
+            uint8_t n = r->prefix;
+            if (strncmp(r->filter,topic,n) != 0) {
+                // "a/#" also matches "a", the prefix is one '/' longer than the topic
+                if (!(n > 0 && r->filter[n-1] == '/' && r->filter[n] == '#' && strncmp(r->filter,topic,n-1) == 0 && topic[n-1] == 0)) continue;
+            } else if (!topicMatches(r->filter+n,topic+n)) {
+                continue;
+            }
+        }
+        r->handler(topic,payload,length);
+        return;
+    }
+    if (callback) {
+        callback(topic,payload,length);
+    }
+}
+
 boolean PubSubClient::subscribe(const char* topic) {
     return subscribe(topic, 0);
 }
@@ -11,6 +11,7 @@
 #include "IPAddress.h"
 #include "Client.h"
 #include "Stream.h"
+#include "Print.h"
 
 #define MQTT_VERSION_3_1      3
 #define MQTT_VERSION_3_1_1    4
@@ -36,6 +37,32 @@
 #define MQTT_SOCKET_TIMEOUT 15
 #endif
 
+// MQTT_QUEUE_SIZE : number of QoS 1 publishes kept until the broker acknowledges them
+#ifndef MQTT_QUEUE_SIZE
+#define MQTT_QUEUE_SIZE 8
+#endif
+
+// MQTT_QUEUE_PAYLOAD : largest payload queuePublish() accepts
+#ifndef MQTT_QUEUE_PAYLOAD
+#define MQTT_QUEUE_PAYLOAD 16
+#endif
+
+// MQTT_QUEUE_RETRY : milliseconds to wait for a PUBACK before sending again
+#ifndef MQTT_QUEUE_RETRY
+#define MQTT_QUEUE_RETRY 5000
+#endif
+
+// MQTT_QUEUE_KEY : queued payloads on the same topic that match up to this
+//  character supersede each other, so "T1:780" replaces a pending "T1:779"
+#ifndef MQTT_QUEUE_KEY
+#define MQTT_QUEUE_KEY ':'
+#endif
+
+// MQTT_MAX_ROUTES : number of topic filters route() can register
+#ifndef MQTT_MAX_ROUTES
+#define MQTT_MAX_ROUTES 4
+#endif
+
 // MQTT_MAX_TRANSFER_SIZE : limit how much data is passed to the network client
 //  in each write call. Needed for the Arduino Wifi Shield. Leave undefined to
 //  pass the entire MQTT packet in each write call.
@@ -80,20 +107,58 @@
 #define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
 #endif
 
-class PubSubClient {
+typedef void (*MQTTRouteHandler)(char*, uint8_t*, unsigned int);
+
+typedef struct {
+   const char* filter;     // not copied, must stay valid
+   uint8_t prefix;         // characters before the first wildcard
+   boolean exact;          // no wildcard at all
+   MQTTRouteHandler handler;
+} MQTTRoute;
+
+typedef struct {
+   const char* topic;      // NULL while the slot is free
+   uint16_t msgId;
+   uint8_t tries;          // 0 until it has been sent on this connection, stops at 255
+   uint8_t length;
+   unsigned long sent;
+   uint8_t payload[MQTT_QUEUE_PAYLOAD];
+} MQTTQueued;
+
+class PubSubClient : public Print {
 private:
    Client* _client;
    uint8_t buffer[MQTT_MAX_PACKET_SIZE];
+   // Incoming packet, apart from buffer so a send can't clobber one that is half in
+   uint8_t rxBuffer[MQTT_MAX_PACKET_SIZE];
    uint16_t nextMsgId;
    unsigned long lastOutActivity;
    unsigned long lastInActivity;
    bool pingOutstanding;
    MQTT_CALLBACK_SIGNATURE;
+   // Partial packet kept between readPacket() calls
+   uint8_t readState;
+   uint8_t readLengthLength;
+   uint16_t readPos;
+   uint16_t readLength;
+   uint16_t readSkip;
+   uint32_t readMultiplier;
+   unsigned long readActivity;
    uint16_t readPacket(uint8_t*);
-   boolean readByte(uint8_t * result);
-   boolean readByte(uint8_t * result, uint16_t * index);
+   // Bytes of a beginPublish() payload staged in buffer
+   uint16_t streamPos;
+   boolean streamOk;
+   boolean flushStream();
+   uint8_t buildHeader(uint8_t header, uint8_t* buf, uint16_t length);
    boolean write(uint8_t header, uint8_t* buf, uint16_t length);
    uint16_t writeString(const char* string, uint8_t* buf, uint16_t pos);
+   MQTTQueued queue[MQTT_QUEUE_SIZE];
+   MQTTRoute routes[MQTT_MAX_ROUTES];
+   uint8_t routeCount;
+   void init();
+   void dispatch(char* topic, uint8_t* payload, unsigned int length);
+   boolean sendQueued(MQTTQueued* entry);
+   void serviceQueue();
    IPAddress ip;
    const char* domain;
    uint16_t port;
@@ -132,6 +197,19 @@ public:
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength);
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
    boolean publish_P(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
+   // QoS 1 publish kept until the broker acknowledges it and sent again after a reconnect.
+   // topic is not copied and must stay valid until then. False when the queue is full.
+   boolean queuePublish(const char* topic, const char* payload);
+   // Streams a publish of plength payload bytes: the header goes out here and the
+   // payload follows through write()/print(), so it never has to fit in buffer
+   boolean beginPublish(const char* topic, unsigned int plength, boolean retained);
+   boolean endPublish();
+   virtual size_t write(uint8_t);
+   virtual size_t write(const uint8_t *buffer, size_t size);
+   // Incoming publishes whose topic matches filter (+ and # allowed) go to handler,
+   // the first matching route wins and anything unrouted goes to the callback.
+   // This only routes, the filter still has to be covered by a subscription.
+   boolean route(const char* filter, MQTTRouteHandler handler);
    boolean subscribe(const char* topic);
    boolean subscribe(const char* topic, uint8_t qos);
    boolean unsubscribe(const char* topic);
@@ -0,0 +1,213 @@
+// Host measurements of the cloud path: how fast state publishes go out and how long
+// a command takes from the broker to the routed handler and back. The numbers are
+// host CPU time and only useful relative to each other, the byte counts are what the
+// W5100 actually has to move.
+#include "PubSubClient.h"
+#include "ShimClient.h"
+#include "Broker.h"
+#include <stdio.h>
+#include <string>
+
+#define PUBLISH_COUNT   10000
+#define COMMAND_COUNT   1000
+
+Broker broker;
+ShimClient shimClient(broker);
+PubSubClient client(shimClient);
+
+int failures = 0;
+unsigned long commands = 0;
+
+void check(boolean ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+void report(const char* what, unsigned long count, unsigned long elapsed, unsigned long bytes) {
+    printf("%-24s %8lu in %7lu us  %8.2f us each  %6.1f bytes each\n",
+           what, count, elapsed, (double)elapsed/count, (double)bytes/count);
+}
+
+// Stands in for MQTTTopicCallback, answers every command on user/out
+void command(char* topic, uint8_t* payload, unsigned int length) {
+    commands++;
+    client.publish("user/out", payload, length);
+}
+
+// Keeps what the dribble test's route was handed
+std::string dribbleTopic;
+std::string dribblePayload;
+
+void dribbled(char* topic, uint8_t* payload, unsigned int length) {
+    dribbleTopic = topic;
+    dribblePayload.assign((const char*)payload, length);
+}
+
+// loop() takes one packet per call, so give it every PUBACK still waiting
+void drain() {
+    while (shimClient.available()) {
+        client.loop();
+    }
+}
+
+void testConnect() {
+    client.setServer("broker", 1883);
+    client.setCallback(command);
+    check(client.connect("RA-user", "user", "pass"), "connect");
+    check(client.subscribe("user/in/#"), "subscribe");
+}
+
+void testPublishRate() {
+    char payload[15];
+
+    broker.reset();
+    unsigned long start = micros();
+    for (int i = 0; i < PUBLISH_COUNT; i++) {
+        sprintf(payload, "T1:%d", 700 + i % 100);
+        client.publish("user/out", payload);
+    }
+    report("QoS 0 publish", PUBLISH_COUNT, micros() - start, broker.bytesIn);
+    check(broker.publishes == PUBLISH_COUNT, "every QoS 0 publish arrived");
+
+    // publishParams() queues a handful of pairs per cycle, then loop() takes the PUBACKs
+    broker.reset();
+    start = micros();
+    for (int i = 0; i < PUBLISH_COUNT; i++) {
+        sprintf(payload, "P%d:%d", i % 4, i);
+        check(client.queuePublish("user/out", payload), "queuePublish accepted");
+        if (i % 4 == 3) {
+            client.loop();
+        }
+    }
+    drain();
+    report("QoS 1 queued publish", PUBLISH_COUNT, micros() - start, broker.bytesIn);
+    check(broker.publishes == PUBLISH_COUNT, "every QoS 1 publish arrived");
+    check(broker.duplicates == 0, "no QoS 1 publish was sent twice");
+}
+
+void testCommandRoundTrip() {
+    unsigned long total = 0;
+    unsigned long worst = 0;
+    unsigned long best = 0xFFFFFFFF;
+    unsigned long loops = 0;
+    unsigned long bytes = 0;
+
+    for (int i = 0; i < COMMAND_COUNT; i++) {
+        char payload[15];
+        sprintf(payload, "2:%d", i);
+        broker.reset();
+        broker.lastPayload.clear();
+        unsigned long start = micros();
+        broker.publish("user/in/mqtt", payload, i & 1);
+        while (broker.lastPayload != payload && loops < (unsigned long)COMMAND_COUNT * 10) {
+            client.loop();
+            loops++;
+        }
+        unsigned long elapsed = micros() - start;
+        total += elapsed;
+        bytes += broker.bytesIn;
+        if (elapsed > worst) worst = elapsed;
+        if (elapsed < best) best = elapsed;
+    }
+    report("command round trip", COMMAND_COUNT, total, bytes);
+    printf("%-24s min %lu us  max %lu us  %.2f loop() calls each\n",
+           "", best, worst, (double)loops/COMMAND_COUNT);
+    check(commands == COMMAND_COUNT, "every command reached the callback");
+}
+
+// Commands arriving a few bytes at a time while the controller keeps sending: every
+// kind of send goes out between the pieces and the command must still come through
+void testDribble() {
+    client.route("user/in/dribble", dribbled);
+    shimClient.dribble = true;
+    for (size_t step = 1; step <= 6; step++) {
+        for (int qos = 0; qos <= 1; qos++) {
+            char payload[15];
+            sprintf(payload, "r:%u", (unsigned)(step * 10 + qos));
+            dribbleTopic.clear();
+            dribblePayload.clear();
+            broker.publish("user/in/dribble", payload, qos);
+            for (int i = 0; i < 1000 && dribbleTopic.empty(); i++) {
+                shimClient.release(step);
+                client.loop();
+                switch (i % 3) {
+                case 0:
+                    client.publish("user/out", "T1:780");
+                    break;
+                case 1:
+                    client.queuePublish("user/out", "P0:1");
+                    break;
+                case 2:
+                    client.beginPublish("user/out", 6, false);
+                    client.print("T2:781");
+                    client.endPublish();
+                    break;
+                }
+            }
+            check(dribbleTopic == "user/in/dribble", "a dribbled command kept its topic");
+            check(dribblePayload == payload, "a dribbled command kept its payload");
+        }
+    }
+    shimClient.dribble = false;
+    shimClient.release(1000);
+    drain();
+}
+
+// Queued publishes still waiting after a reconnect must not share an id with new ones,
+// or the new one's PUBACK takes the old one out of the queue unsent
+void testReconnect() {
+    shimClient.drop();
+    check(client.connect("RA-user", "user", "pass"), "reconnect");
+    broker.holdAcks = true;
+    client.queuePublish("user/out", "P0:1");
+    client.queuePublish("user/out", "P1:1");
+    client.queuePublish("user/out", "P2:1");
+    shimClient.drop();
+    check(client.connect("RA-user", "user", "pass"), "reconnect with publishes queued");
+    broker.holdAcks = false;
+    client.queuePublish("user/out", "P3:1");
+    for (int i = 0; i < 10; i++) {
+        client.loop();
+    }
+    check(broker.publishes == 4, "every queued publish went out after the reconnect");
+    check(broker.duplicates == 0, "queued publishes went out fresh after the reconnect");
+}
+
+// A broker that stops acknowledging gets the publish again every MQTT_QUEUE_RETRY
+// until it does, the value is never dropped
+void testRetry() {
+    broker.reset();
+    broker.holdAcks = true;
+    client.queuePublish("user/out", "P0:2");
+    for (int i = 0; i < 5; i++) {
+        advanceMillis(MQTT_QUEUE_RETRY + 1);
+        client.loop();
+    }
+    check(broker.publishes == 6, "an unacknowledged publish was sent again every retry");
+    check(broker.duplicates == 5, "retries were flagged DUP");
+    broker.holdAcks = false;
+    advanceMillis(MQTT_QUEUE_RETRY + 1);
+    client.loop();
+    drain();
+    advanceMillis(MQTT_QUEUE_RETRY + 1);
+    client.loop();
+    check(broker.publishes == 7, "the PUBACK ended the retries");
+    check(broker.lastPayload == "P0:2", "the retried value arrived");
+}
+
+int main() {
+    testConnect();
+    testPublishRate();
+    testCommandRoundTrip();
+    testDribble();
+    testReconnect();
+    testRetry();
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
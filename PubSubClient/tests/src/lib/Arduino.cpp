@@ -0,0 +1,23 @@
+#include "Arduino.h"
+#include <sys/time.h>
+
+static unsigned long long nowMicros() {
+    struct timeval tv;
+    gettimeofday(&tv,NULL);
+    return (unsigned long long)tv.tv_sec*1000000ULL + tv.tv_usec;
+}
+
+static unsigned long long start = nowMicros();
+static unsigned long long skipped = 0;
+
+unsigned long millis() {
+    return (unsigned long)((nowMicros()-start+skipped)/1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)(nowMicros()-start+skipped);
+}
+
+void advanceMillis(unsigned long ms) {
+    skipped += ms*1000ULL;
+}
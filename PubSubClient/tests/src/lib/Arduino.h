@@ -0,0 +1,21 @@
+// Host stand-in for the parts of Arduino.h PubSubClient uses
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Flash and RAM are the same thing on the host
+#define PROGMEM
+#define pgm_read_byte_near(p) (*(const uint8_t*)(p))
+
+unsigned long millis();
+unsigned long micros();
+// Moves millis() and micros() ahead without waiting
+void advanceMillis(unsigned long ms);
+
+#endif
@@ -0,0 +1,116 @@
+#include "Broker.h"
+#include "ShimClient.h"
+
+Broker::Broker() {
+    client = NULL;
+    nextMsgId = 0;
+    holdAcks = false;
+    reset();
+}
+
+void Broker::attach(ShimClient* client) {
+    this->client = client;
+}
+
+void Broker::reset() {
+    packet.clear();
+    bytesIn = 0;
+    publishes = 0;
+    duplicates = 0;
+}
+
+void Broker::respond(const uint8_t *buf, size_t size) {
+    if (client) {
+        client->respond(buf,size);
+    }
+}
+
+void Broker::receive(const uint8_t *buf, size_t size) {
+    bytesIn += size;
+    packet.insert(packet.end(),buf,buf+size);
+    // Take every complete packet off the front
+    while (packet.size() >= 2) {
+        uint32_t length = 0;
+        uint32_t multiplier = 1;
+        size_t pos = 1;
+        uint8_t digit;
+        do {
+            if (pos == packet.size()) {
+                return;
+            }
+            digit = packet[pos++];
+            length += (digit & 127) * multiplier;
+            multiplier *= 128;
+        } while ((digit & 128) != 0);
+        if (packet.size() < pos+length) {
+            return;
+        }
+        handle(packet[0],&packet[pos],length);
+        packet.erase(packet.begin(),packet.begin()+pos+length);
+    }
+}
+
+void Broker::handle(uint8_t header, const uint8_t *body, uint32_t length) {
+    switch (header & 0xF0) {
+    case 0x10: { // CONNECT
+        uint8_t connack[] = {0x20,2,0,0};
+        respond(connack,sizeof(connack));
+        break;
+    }
+    case 0x30: { // PUBLISH
+        uint8_t qos = (header >> 1) & 3;
+        uint16_t tlen = (body[0] << 8) + body[1];
+        uint32_t pos = 2 + tlen;
+        lastTopic.assign((const char*)body+2,tlen);
+        if (qos) {
+            uint8_t puback[] = {0x40,2,body[pos],body[pos+1]};
+            pos += 2;
+            if (!holdAcks) {
+                respond(puback,sizeof(puback));
+            }
+        }
+        lastPayload.assign((const char*)body+pos,length-pos);
+        publishes++;
+        if (header & 0x08) {
+            duplicates++;
+        }
+        break;
+    }
+    case 0x80: { // SUBSCRIBE
+        uint8_t suback[] = {0x90,3,body[0],body[1],0};
+        respond(suback,sizeof(suback));
+        break;
+    }
+    case 0xC0: { // PINGREQ
+        uint8_t pingresp[] = {0xD0,0};
+        respond(pingresp,sizeof(pingresp));
+        break;
+    }
+    }
+}
+
+void Broker::publish(const char* topic, const char* payload, uint8_t qos) {
+    std::vector<uint8_t> p;
+    uint16_t tlen = strlen(topic);
+    uint32_t plen = strlen(payload);
+    uint32_t length = 2 + tlen + (qos ? 2 : 0) + plen;
+    p.push_back(0x30 | (qos << 1));
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        if (length > 0) {
+            digit |= 0x80;
+        }
+        p.push_back(digit);
+    } while (length > 0);
+    p.push_back(tlen >> 8);
+    p.push_back(tlen & 0xFF);
+    p.insert(p.end(),topic,topic+tlen);
+    if (qos) {
+        nextMsgId++;
+        p.push_back(nextMsgId >> 8);
+        p.push_back(nextMsgId & 0xFF);
+    }
+    p.insert(p.end(),payload,payload+plen);
+    respond(&p[0],p.size());
+}
@@ -0,0 +1,36 @@
+// Minimal broker stand-in: answers CONNECT, SUBSCRIBE, PINGREQ and QoS 1 PUBLISH,
+// keeps the last publish it received and can send publishes to the client
+#ifndef Broker_h
+#define Broker_h
+
+#include "Arduino.h"
+#include <string>
+#include <vector>
+
+class ShimClient;
+
+class Broker {
+private:
+    ShimClient* client;
+    std::vector<uint8_t> packet;
+    uint16_t nextMsgId;
+    void handle(uint8_t header, const uint8_t *body, uint32_t length);
+    void respond(const uint8_t *buf, size_t size);
+public:
+    Broker();
+    void attach(ShimClient* client);
+    void reset();
+    void receive(const uint8_t *buf, size_t size);
+    // Sends a PUBLISH to the client
+    void publish(const char* topic, const char* payload, uint8_t qos);
+
+    // Hold back PUBACKs, as a broker that is slow or gone would
+    boolean holdAcks;
+    unsigned long bytesIn;
+    unsigned long publishes;
+    unsigned long duplicates;
+    std::string lastTopic;
+    std::string lastPayload;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef IPAddress_h
+#define IPAddress_h
+
+class IPAddress {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t, uint8_t, uint8_t, uint8_t) {}
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "ShimClient.h"
+#include "Broker.h"
+
+ShimClient::ShimClient(Broker& broker) {
+    this->broker = &broker;
+    this->incomingPos = 0;
+    this->up = false;
+    this->dribble = false;
+    broker.attach(this);
+}
+
+int ShimClient::connect(IPAddress ip, uint16_t port) {
+    return connect((const char*)NULL,port);
+}
+
+int ShimClient::connect(const char *host, uint16_t port) {
+    incoming.clear();
+    incomingPos = 0;
+    held.clear();
+    up = true;
+    broker->reset();
+    return 1;
+}
+
+size_t ShimClient::write(uint8_t b) {
+    return write(&b,1);
+}
+
+size_t ShimClient::write(const uint8_t *buf, size_t size) {
+    if (!up) {
+        return 0;
+    }
+    broker->receive(buf,size);
+    return size;
+}
+
+int ShimClient::available() {
+    return incoming.size()-incomingPos;
+}
+
+int ShimClient::read() {
+    if (incomingPos == incoming.size()) {
+        return -1;
+    }
+    uint8_t b = incoming[incomingPos++];
+    if (incomingPos == incoming.size()) {
+        incoming.clear();
+        incomingPos = 0;
+    }
+    return b;
+}
+
+void ShimClient::flush() {}
+
+void ShimClient::stop() {
+    up = false;
+}
+
+uint8_t ShimClient::connected() {
+    return up;
+}
+
+void ShimClient::respond(const uint8_t *buf, size_t size) {
+    if (dribble) {
+        held.insert(held.end(),buf,buf+size);
+    } else {
+        incoming.insert(incoming.end(),buf,buf+size);
+    }
+}
+
+void ShimClient::release(size_t count) {
+    if (count > held.size()) {
+        count = held.size();
+    }
+    incoming.insert(incoming.end(),held.begin(),held.begin()+count);
+    held.erase(held.begin(),held.begin()+count);
+}
+
+void ShimClient::drop() {
+    up = false;
+    incoming.clear();
+    incomingPos = 0;
+    held.clear();
+}
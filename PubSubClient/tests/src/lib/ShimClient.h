@@ -0,0 +1,39 @@
+// Loopback Client: whatever PubSubClient writes goes to a Broker,
+// whatever the Broker answers is read back by PubSubClient
+#ifndef ShimClient_h
+#define ShimClient_h
+
+#include "Client.h"
+#include <vector>
+
+class Broker;
+
+class ShimClient : public Client {
+private:
+    Broker* broker;
+    std::vector<uint8_t> incoming;
+    size_t incomingPos;
+    std::vector<uint8_t> held;
+    boolean up;
+public:
+    ShimClient(Broker& broker);
+    virtual int connect(IPAddress ip, uint16_t port);
+    virtual int connect(const char *host, uint16_t port);
+    virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *buf, size_t size);
+    virtual int available();
+    virtual int read();
+    virtual void flush();
+    virtual void stop();
+    virtual uint8_t connected();
+    // Queues bytes for PubSubClient to read
+    void respond(const uint8_t *buf, size_t size);
+    // Drops the connection without telling PubSubClient
+    void drop();
+    // While set, broker bytes wait until release() lets them through, as they
+    // would trickle in over a slow link
+    boolean dribble;
+    void release(size_t count);
+};
+
+#endif
@@ -1154,22 +1154,22 @@ void RA_PWMClass::SIXTEENChannelPWMSigmoid(byte Channel, byte Start, byte End, i
 
 int RA_PWMClass::Parabola(byte Start, byte End, int PrevValue, int PreMinuteOffset, int PostMinuteOffset) 
 {
-	SetWaveForm(Parabola_Type,Start,End,0,PrevValue,PreMinuteOffset,PostMinuteOffset);
+	return SetWaveForm(Parabola_Type,Start,End,0,PrevValue,PreMinuteOffset,PostMinuteOffset);
 }
 
 int RA_PWMClass::Slope(byte Start, byte End, byte Duration, int PrevValue, int PreMinuteOffset, int PostMinuteOffset) 
 {
-	SetWaveForm(Slope_Type,Start,End,Duration,PrevValue,PreMinuteOffset,PostMinuteOffset);
+	return SetWaveForm(Slope_Type,Start,End,Duration,PrevValue,PreMinuteOffset,PostMinuteOffset);
 }
 
 int RA_PWMClass::SmoothRamp(byte Start, byte End, byte Duration, int PrevValue, int PreMinuteOffset, int PostMinuteOffset) 
 {
-	SetWaveForm(SmoothRamp_Type,Start,End,Duration,PrevValue,PreMinuteOffset,PostMinuteOffset);
+	return SetWaveForm(SmoothRamp_Type,Start,End,Duration,PrevValue,PreMinuteOffset,PostMinuteOffset);
 }
 
 int RA_PWMClass::Sigmoid(byte Start, byte End, int PrevValue, int PreMinuteOffset, int PostMinuteOffset) 
 {
-	SetWaveForm(Sigmoid_Type,Start,End,0,PrevValue,PreMinuteOffset,PostMinuteOffset);
+	return SetWaveForm(Sigmoid_Type,Start,End,0,PrevValue,PreMinuteOffset,PostMinuteOffset);
 }
 
 int RA_PWMClass::SetWaveForm(byte type, byte Start, byte End, byte Duration, int PrevValue, int PreMinuteOffset, int PostMinuteOffset)
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2010 Reef Angel / Roberto Imai
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RA_Profiler.h"
+
+RA_ProfilerClass::RA_ProfilerClass()
+{
+	Reset();
+}
+
+void RA_ProfilerClass::Reset()
+{
+	for (byte a=0;a<PROFILE_STAGES;a++)
+	{
+		StageMin[a]=0xFFFFFFFF;
+		StageMax[a]=0;
+		StageSum[a]=0;
+		StageCount[a]=0;
+	}
+	LoopMax=0;
+	Overruns=0;
+	LoopStart=micros();
+	LastMark=LoopStart;
+}
+
+void RA_ProfilerClass::Start()
+{
+	LoopStart=micros();
+	LastMark=LoopStart;
+}
+
+void RA_ProfilerClass::Mark(byte stage)
+{
+	unsigned long m=micros();
+	Sample(stage,m-LastMark);
+	LastMark=m;
+}
+
+void RA_ProfilerClass::Sample(byte stage, unsigned long d)
+{
+	if (d<StageMin[stage]) StageMin[stage]=d;
+	if (d>StageMax[stage]) StageMax[stage]=d;
+	// Halve the window once it fills up so the average keeps following recent loops
+	if (StageCount[stage]==PROFILE_WINDOW)
+	{
+		StageSum[stage]>>=1;
+		StageCount[stage]>>=1;
+	}
+	StageSum[stage]+=d;
+	StageCount[stage]++;
+}
+
+void RA_ProfilerClass::End()
+{
+	unsigned long d=micros()-LoopStart;
+	if (d>LoopMax) LoopMax=d;
+	if (d>PROFILE_BUDGET) Overruns++;
+}
+
+unsigned long RA_ProfilerClass::GetAvg(byte stage)
+{
+	if (StageCount[stage]==0) return 0;
+	return StageSum[stage]/StageCount[stage];
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2010 Reef Angel / Roberto Imai
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __RA_PROFILER_H__
+#define __RA_PROFILER_H__
+
+#include <Globals.h>
+
+// Stage timing for ReefAngelClass::Refresh()
+// Each Mark() charges the time elapsed since the previous mark to the given stage.
+// Sample() records a duration measured elsewhere, e.g. one cloud command.
+// All values are in microseconds.
+class RA_ProfilerClass
+{
+public:
+	RA_ProfilerClass();
+	void Start();
+	void Mark(byte stage);
+	void Sample(byte stage, unsigned long d);
+	void End();
+	void Reset();
+	unsigned long GetAvg(byte stage);
+	inline unsigned long GetMin(byte stage) { return StageCount[stage]?StageMin[stage]:0; };
+	inline unsigned long GetMax(byte stage) { return StageMax[stage]; };
+	unsigned long LoopMax;
+	unsigned int Overruns;
+private:
+	unsigned long LoopStart;
+	unsigned long LastMark;
+	unsigned long StageMin[PROFILE_STAGES];
+	unsigned long StageMax[PROFILE_STAGES];
+	unsigned long StageSum[PROFILE_STAGES];
+	unsigned int StageCount[PROFILE_STAGES];
+};
+
+#endif  // __RA_PROFILER_H__
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2010 Reef Angel / Roberto Imai
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RA_Sampler.h"
+
+RA_SamplerClass::RA_SamplerClass()
+{
+	Clear();
+}
+
+void RA_SamplerClass::Clear()
+{
+	Index=0;
+	Count=0;
+}
+
+void RA_SamplerClass::Add(int value)
+{
+	Samples[Index]=value;
+	Index++;
+	if (Index==ADC_SAMPLES) Index=0;
+	if (Count<ADC_SAMPLES) Count++;
+}
+
+int RA_SamplerClass::Get()
+{
+	if (Count==0) return 0;
+	int sorted[ADC_SAMPLES];
+	// insertion sort, the window is small
+	for (byte a=0;a<Count;a++)
+	{
+		int v=Samples[a];
+		byte b=a;
+		while (b>0 && sorted[b-1]>v)
+		{
+			sorted[b]=sorted[b-1];
+			b--;
+		}
+		sorted[b]=v;
+	}
+	byte trim=Count/4;
+	long sum=0;
+	for (byte a=trim;a<Count-trim;a++)
+		sum+=sorted[a];
+	return sum/(Count-2*trim);
+}
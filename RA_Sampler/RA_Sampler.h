@@ -0,0 +1,48 @@
+/*
+ * Copyright 2010 Reef Angel / Roberto Imai
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __RA_SAMPLER_H__
+#define __RA_SAMPLER_H__
+
+#include <Globals.h>
+
+#ifndef ADC_SAMPLES
+#define ADC_SAMPLES		16
+#endif  // ADC_SAMPLES
+
+// Milliseconds between readings of the I2C expansion sensors
+#ifndef SAMPLE_PERIOD
+#define SAMPLE_PERIOD	50
+#endif  // SAMPLE_PERIOD
+
+// Ring buffer of raw sensor readings.
+// Add() stores one sample per loop, Get() returns the mean of the middle half of the
+// sorted window so single spikes on either side never reach the average.
+class RA_SamplerClass
+{
+public:
+	RA_SamplerClass();
+	void Add(int value);
+	int Get();
+	void Clear();
+	inline byte GetCount() { return Count; };
+private:
+	int Samples[ADC_SAMPLES];
+	byte Index;
+	byte Count;
+};
+
+#endif  // __RA_SAMPLER_H__
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2010 Reef Angel / Roberto Imai
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RA_Scheduler.h"
+
+RA_SchedulerClass::RA_SchedulerClass()
+{
+	TaskCount=0;
+	RunIndex=0;
+	NextDue=0;
+}
+
+byte RA_SchedulerClass::Add(TaskCallback callback, unsigned int interval)
+{
+	if (TaskCount==MAX_TASKS) return TASK_NONE;
+	Tasks[TaskCount]=callback;
+	Interval[TaskCount]=interval;
+	Due[TaskCount]=millis()+interval;
+	TaskCount++;
+	UpdateNextDue();
+	return TaskCount-1;
+}
+
+void RA_SchedulerClass::SetInterval(byte id, unsigned int interval)
+{
+	if (id>=TaskCount || Interval[id]==interval) return;
+	// Subtract first, interval-Interval[id] would wrap in unsigned int when the interval shrinks
+	Due[id]=Due[id]-Interval[id]+interval;
+	Interval[id]=interval;
+	UpdateNextDue();
+}
+
+void RA_SchedulerClass::Run(byte budget)
+{
+	unsigned long m=millis();
+	if ((long)(m-NextDue)<0) return;
+	// Start where the last Run() stopped so a tight budget can't starve the last tasks
+	for (byte a=0; a<TaskCount && budget; a++)
+	{
+		byte t=RunIndex;
+		RunIndex++;
+		if (RunIndex==TaskCount) RunIndex=0;
+		if ((long)(m-Due[t])>=0)
+		{
+			Due[t]+=Interval[t];
+			// Don't try to catch up on missed runs, just start over from now
+			if ((long)(m-Due[t])>=0) Due[t]=m+Interval[t];
+			Tasks[t]();
+			budget--;
+		}
+	}
+	UpdateNextDue();
+}
+
+void RA_SchedulerClass::UpdateNextDue()
+{
+	if (TaskCount==0) return;
+	NextDue=Due[0];
+	for (byte a=1; a<TaskCount; a++)
+		if ((long)(Due[a]-NextDue)<0) NextDue=Due[a];
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2010 Reef Angel / Roberto Imai
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __RA_SCHEDULER_H__
+#define __RA_SCHEDULER_H__
+
+#include <Globals.h>
+
+#define MAX_TASKS			8
+#define TASK_NONE			0xFF
+
+#ifndef SCHEDULER_BUDGET
+#define SCHEDULER_BUDGET	2	// maximum number of tasks run by a single Run()
+#endif  // SCHEDULER_BUDGET
+
+typedef void (*TaskCallback)();
+
+// Fixed size table of periodic tasks keyed on millis().
+// The earliest deadline is cached, so Run() costs one compare when nothing is due.
+// TimerClass (one-shot deadlines in seconds, like feeding mode) and the wave modes in
+// Globals (state kept per call with the caller's arguments) aren't periodic tasks and
+// keep their own timing.
+class RA_SchedulerClass
+{
+public:
+	RA_SchedulerClass();
+	byte Add(TaskCallback callback, unsigned int interval);
+	void SetInterval(byte id, unsigned int interval);
+	void Run(byte budget=SCHEDULER_BUDGET);
+private:
+	void UpdateNextDue();
+	TaskCallback Tasks[MAX_TASKS];
+	unsigned int Interval[MAX_TASKS];
+	unsigned long Due[MAX_TASKS];
+	unsigned long NextDue;
+	byte TaskCount;
+	byte RunIndex;
+};
+
+#endif  // __RA_SCHEDULER_H__
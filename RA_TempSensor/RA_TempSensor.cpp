@@ -28,6 +28,11 @@ OneWire ds(tempPin);
 RA_TempSensorClass::RA_TempSensorClass()
 {
     unit = DEGREE_F;
+    Value = 0;
+    State = TEMP_CONVERT;
+    ReadIndex = 0;
+    CycleDone = false;
+    ConvertStart = 0;
 }
 
 void RA_TempSensorClass::Init()
@@ -60,8 +65,12 @@ void RA_TempSensorClass::RemapSensors(byte map[ProbeCount]) {
     
 void RA_TempSensorClass::RequestConversion()
 {
-    for (int i = 0; i < ProbeCount; i++)
-	    SendRequest(addrArray[i]);
+	// A single skip-ROM convert starts every probe on the bus at once
+	if (ds.reset())
+	{
+		ds.skip();
+		ds.write(0x44,0);
+	}
 }
 
 void RA_TempSensorClass::SendRequest(byte addr[8])
@@ -90,10 +99,11 @@ int RA_TempSensorClass::ReadTemperature(byte addr[8])
 			ds.reset();
 			ds.select(addr);
 			ds.write(0xBE);
-			for (byte i = 0; i < 2; i++)
+			for (byte i = 0; i < 9; i++)
 			{	     // we need 9 bytes
 				data[i] = ds.read();
 			}
+			if (OneWire::crc8(data,8)!=data[8]) return 0;
 	//		if (SensorID==count)
 	//		{
                 if ((millis()<1000) && (data[0]==80) && (data[1]==5)) return 0;
@@ -111,3 +121,54 @@ int RA_TempSensorClass::ReadTemperature(byte addr[8])
 	return Temp;
 }
 
+byte RA_TempSensorClass::Update()
+{
+	// Advances the conversion pipeline by one step and reads at most one probe per call.
+	// Returns the index of the probe stored in Value, or TEMP_NONE.
+	byte probe=TEMP_NONE;
+	CycleDone=false;
+	switch (State)
+	{
+	case TEMP_CONVERT:
+		if (NextProbe(0)<ProbeCount)
+		{
+			RequestConversion();
+			ConvertStart=millis();
+			State=TEMP_WAIT;
+		}
+		else
+		{
+			CycleDone=true;
+		}
+		break;
+	case TEMP_WAIT:
+		// Probes hold the bus low until the conversion is done
+		if (ds.read_bit()==0 && millis()-ConvertStart<TEMP_CONVERT_TIMEOUT) break;
+		ReadIndex=NextProbe(0);
+		State=TEMP_READ;
+		// no break, read the first probe right away
+	case TEMP_READ:
+		if (ReadIndex>=ProbeCount)
+		{
+			CycleDone=true;
+			State=TEMP_CONVERT;
+			break;
+		}
+		probe=ReadIndex;
+		Value=ReadTemperature(addrArray[probe]);
+		ReadIndex=NextProbe(probe+1);
+		if (ReadIndex>=ProbeCount)
+		{
+			CycleDone=true;
+			State=TEMP_CONVERT;
+		}
+		break;
+	}
+	return probe;
+}
+
+byte RA_TempSensorClass::NextProbe(byte index)
+{
+	while (index<ProbeCount && addrArray[index][0]!=0x28) index++;
+	return index;
+}
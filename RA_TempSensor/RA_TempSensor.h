@@ -24,6 +24,14 @@ typedef unsigned char byte;
 
 #include <Globals.h>
 
+// Conversion pipeline states
+#define TEMP_CONVERT		0
+#define TEMP_WAIT			1
+#define TEMP_READ			2
+
+#define TEMP_NONE			0xFF	// Update() did not read a probe
+#define TEMP_CONVERT_TIMEOUT	1000	// give up waiting on a conversion after this (ms)
+
 class RA_TempSensorClass
 {
 public:
@@ -32,6 +40,9 @@ public:
 	void RequestConversion();
 	int ReadTemperature(byte addr[8]);
 	void SendRequest(byte addr[8]);
+	byte Update();
+	inline boolean IsCycleDone() { return CycleDone; };
+	int Value;
 
 	byte addrT1[8];
 	byte addrT2[8];
@@ -47,6 +58,12 @@ public:
     byte* addrArray[ProbeCount];
     void RemapSensors(byte map[ProbeCount]);
 	byte unit;
+private:
+	byte NextProbe(byte index);
+	byte State;
+	byte ReadIndex;
+	boolean CycleDone;
+	unsigned long ConvertStart;
 };
 
 #endif // __RA_TEMPSENSOR_H__
@@ -40,7 +40,6 @@ byte CalStep;
 byte RANetSeq, RANetCRC;
 byte RANetData[RANET_SIZE];
 byte RANetStatus[RANET_SIZE];
-unsigned long RANetlastmillis;
 
 void SetOrientation(byte o);
 void CalibrateTouchScreen();
@@ -26,6 +26,53 @@
 #include <DS1307RTC.h>
 #include <ReefAngel.h>
 
+// Request routes, matched one byte at a time by PushBuffer().
+// Keep this table sorted in strcmp order. No route may be a prefix of another one.
+// Routes stored as 256-REQ_xx read numeric parameters up to the next space.
+typedef struct
+{
+	char path[17];
+	byte reqtype;
+} WebRoute;
+
+static const WebRoute WebRoutes[] PROGMEM = {
+	{"GET / ",REQ_ROOT},
+	{"GET /boot",REQ_REBOOT},
+	{"GET /bp",256-REQ_BTN_PRESS},
+	{"GET /cal",256-REQ_CALIBRATION},
+#ifdef CUSTOM_VARIABLES
+	{"GET /cvar",256-REQ_M_CVAR},
+#endif  // CUSTOM_VARIABLES
+	{"GET /d",256-REQ_DATE},
+#ifdef ETH_WIZ5100
+	{"GET /events",REQ_EVENTS},
+#endif  // ETH_WIZ5100
+	{"GET /favicon.ico",REQ_FAVICON},
+	{"GET /json",REQ_JSON},
+	{"GET /l0",256-REQ_LIGHTSOFF},
+	{"GET /l1",256-REQ_LIGHTSON},
+	{"GET /mb",256-REQ_M_BYTE},
+	{"GET /mf",256-REQ_FEEDING},
+	{"GET /mi",256-REQ_M_INT},
+	{"GET /ml",256-REQ_ALARM_LEAK},
+	{"GET /mo",256-REQ_ALARM_OVERHEAT},
+	{"GET /mr",256-REQ_M_RAW},
+	{"GET /mt",256-REQ_ALARM_ATO},
+	{"GET /mw",256-REQ_WATER},
+	{"GET /po",256-REQ_OVERRIDE},
+	{"GET /r",256-REQ_RELAY},
+	{"GET /sa",256-REQ_RA_STATUS},
+	{"GET /sb",REQ_BINARY},
+	{"GET /sd",REQ_SCHEMA},
+	{"GET /sr",256-REQ_R_STATUS},
+	{"GET /v",256-REQ_VERSION},
+	{"GET /wifi",REQ_WIFI},
+	{"HTTP/1.",256-REQ_HTTP},
+#ifdef CLOUD_WIFI
+	{"cloud:",256-REQ_CLOUD},
+#endif  // CLOUD_WIFI
+};
+
 RA_Wifi::RA_Wifi()
 {
 #if !defined ETH_WIZ5100
@@ -45,6 +92,16 @@ RA_Wifi::RA_Wifi()
 //  bHasComma = false;
   bCommaCount = 0;
   webnegoption=false;
+  m_lastchar=0;
+  measuring=false;
+  buffering=false;
+  keepalive=false;
+#ifdef ETH_WIZ5100
+  eventstream=false;
+#endif  // ETH_WIZ5100
+  outlength=0;
+  etagstate=0;
+  etagmatch=0;
   portalusername="";
   portalkey="";
   portalsubdomain="";
@@ -77,163 +134,172 @@ void RA_Wifi::ModeResponse(bool fOk)
 
 void RA_Wifi::PushBuffer(byte inStr)
 {
-	m_pushback[m_pushbackindex]=inStr;
-	m_pushback[m_pushbackindex+1]=0;
 	if (reqtype>0 && reqtype<128)
 	{
 //		if (authStr[m_pushbackindex]==inStr) m_pushbackindex++; else m_pushbackindex=0;
 //		if (authStr[m_pushbackindex]==0) auth=true;
 		//if (m_pushbackindex>0) Serial.println(m_pushbackindex,DEC);
 		//if (m_pushbackindex>0) Serial.println(test,DEC);
+		ParseHeader(inStr);
 		if (usingAuth && !auth) auth=_wifiSerial->find(encodeduserpass);
 		if (reqtype==10) auth=true;
 		_wifiSerial->flush();
 	}
-	else
+	else if (reqtype==REQ_UNKNOWN)
+	{
+		// malformed request, the rest of it is discarded
+	}
+#ifdef CLOUD_WIFI
+	else if (reqtype==256-REQ_CLOUD)
 	{
-		m_pushbackindex++;
-		if (m_pushbackindex==32) m_pushbackindex=0;
-		if (reqtype>128)
+		if (inStr==' ')
 		{
-		    if (inStr==' ')
-		    {
-		        reqtype=256-reqtype;
-		       if ( (reqtype == REQ_M_BYTE) || (reqtype == REQ_M_INT) || (reqtype == REQ_M_RAW || reqtype == REQ_OVERRIDE || reqtype == REQ_M_CVAR) )
-		        {
-		        	// must have a comma to have second value
-		        	// verify that the last char was a digit
-		        	if ( isdigit(m_pushback[m_pushbackindex-2]) )
-		        	{
-		        		// check for the comma to determine how we proceed
-		        		if ( bCommaCount )
-		        		{
-		        			bHasSecondValue = true;
-		        		}
-		        		else
-		        		{
-		        			bHasSecondValue = false;
-		        			weboption2 = weboption;
-		        		}
-		        	}
-		        }
-		        if ( reqtype == REQ_DATE )
-		        {
-		        	// last char must be a digit
-					if ( isdigit(m_pushback[m_pushbackindex-2]) )
+			m_pushback[m_pushbackindex]=0;
+			MQTTSubCallback("",(byte*)m_pushback,m_pushbackindex+1);
+			while(_wifiSerial->available()) _wifiSerial->read();
+			m_pushbackindex=0;
+			reqtype=0;
+		}
+		else if (m_pushbackindex<sizeof(m_pushback)-1)
+		{
+			m_pushback[m_pushbackindex++]=inStr;
+		}
+	}
+#endif // CLOUD_WIFI
+	else if (reqtype>128)
+	{
+	    if (inStr==' ')
+	    {
+	        reqtype=256-reqtype;
+	       if ( (reqtype == REQ_M_BYTE) || (reqtype == REQ_M_INT) || (reqtype == REQ_M_RAW || reqtype == REQ_OVERRIDE || reqtype == REQ_M_CVAR) )
+	        {
+	        	// must have a comma to have second value
+	        	// verify that the last char was a digit
+	        	if ( isdigit(m_lastchar) )
+	        	{
+	        		// check for the comma to determine how we proceed
+	        		if ( bCommaCount )
+	        		{
+	        			bHasSecondValue = true;
+	        		}
+	        		else
+	        		{
+	        			bHasSecondValue = false;
+	        			weboption2 = weboption;
+	        		}
+	        	}
+	        }
+	        if ( reqtype == REQ_DATE )
+	        {
+	        	// last char must be a digit
+				if ( isdigit(m_lastchar) )
+				{
+					// comma count must be 2 otherwise it's an error
+					// if not, set weboption to -1 to signify an error
+					if ( bCommaCount != 2 )
 					{
-						// comma count must be 2 otherwise it's an error
-						// if not, set weboption to -1 to signify an error
-						if ( bCommaCount != 2 )
-						{
-							weboption = -1;
-						}
+						weboption = -1;
+					}
+				}
+				else
+				{
+					// last digit not a char and no commas means we need to
+					// send the current date/time of the controller
+					if ( bCommaCount == 0 )
+					{
+						weboption = -2;
 					}
 					else
 					{
-						// last digit not a char and no commas means we need to
-						// send the current date/time of the controller
-						if ( bCommaCount == 0 )
-						{
-							weboption = -2;
-						}
-						else
-						{
-							weboption = -1;
-						}
+						weboption = -1;
 					}
-		        }
-		    }
-		    else if (inStr == ',')
-		    {
-		    	// when we hit a comma, copy the first value (weboption) to weboption2
-		    	// then skip over the comma and put the value to be written into weboption
-		    	// second comma copies the value into weboption3
-				bCommaCount++;
-				if ( bCommaCount == 1 )
-					weboption2 = weboption;
-				else if ( bCommaCount == 2 )
-					weboption3 = weboption;
-		    	// reset weboption to 0
-		    	weboption = 0;
-		    }
-		    else if (inStr == '-')
-		    {
-		    	webnegoption=true;
-		    }
-		    else if(isdigit(inStr))
-		    {
-		    	// process digits here
-				weboption*=10;
-				weboption+=inStr-'0';
-		    }
-		    // 3/14/11 - curt
-		    //else all other chars are discarded
-		    // consider further sanity checks to ensure that we don't get any malformed strings or commands
-		    // right now, we can embed non digits in the parameters and as long as the last char is a digit,
-		    // it is ok and the non digits are just skipped over
-		    // we may want to signal an error or break out of processing the string to indicate there is an error
-		    // maybe set weboption2 and weboption to -1 or 0
-		    // could also flush the buffer and set reqtype to a REQ_ERROR or something
-		    // need to give this more thought
-		    //
-		    // NOTES about too large of value being stored
-		    //   if you exceed the storage limit for the variable, the negative value gets stored
-		    //   so we should limit the value being saved from the client side
-		    //   otherwise we would have to do additional checks in here for the size and that would
-		    //   require more code
-		    //   Users shouldn't be manually changing values from the web without an interface that
-		    //   limits them, so we "should" be safe (in theory), but this may need to be revisited
-		    //   in the future.  - curt (3/14/11)
+				}
+	        }
+	    }
+	    else if (inStr == ',')
+	    {
+	    	// when we hit a comma, copy the first value (weboption) to weboption2
+	    	// then skip over the comma and put the value to be written into weboption
+	    	// second comma copies the value into weboption3
+			bCommaCount++;
+			if ( bCommaCount == 1 )
+				weboption2 = weboption;
+			else if ( bCommaCount == 2 )
+				weboption3 = weboption;
+	    	// reset weboption to 0
+	    	weboption = 0;
+	    }
+	    else if (inStr == '-')
+	    {
+	    	webnegoption=true;
+	    }
+	    else if(isdigit(inStr))
+	    {
+	    	// process digits here
+			weboption*=10;
+			weboption+=inStr-'0';
+	    }
+	    // 3/14/11 - curt
+	    //else all other chars are discarded
+	    // consider further sanity checks to ensure that we don't get any malformed strings or commands
+	    // right now, we can embed non digits in the parameters and as long as the last char is a digit,
+	    // it is ok and the non digits are just skipped over
+	    // we may want to signal an error or break out of processing the string to indicate there is an error
+	    // maybe set weboption2 and weboption to -1 or 0
+	    // could also flush the buffer and set reqtype to a REQ_ERROR or something
+	    // need to give this more thought
+	    //
+	    // NOTES about too large of value being stored
+	    //   if you exceed the storage limit for the variable, the negative value gets stored
+	    //   so we should limit the value being saved from the client side
+	    //   otherwise we would have to do additional checks in here for the size and that would
+	    //   require more code
+	    //   Users shouldn't be manually changing values from the web without an interface that
+	    //   limits them, so we "should" be safe (in theory), but this may need to be revisited
+	    //   in the future.  - curt (3/14/11)
+		m_lastchar=inStr;
+	}
+	else
+	{
+		// Narrow the routes that still match the request line, m_pushbackindex is the
+		// position in the line. Split packets just continue where the last byte left off.
+		if (m_pushbackindex==0)
+		{
+			routelo=0;
+			routehi=SIZE(WebRoutes);
 		}
-		else
+		if (routelo==routehi)
 		{
-            if (strncmp("GET / ", m_pushback, 6)==0) reqtype = REQ_ROOT;
-            else if (strncmp("GET /wifi", m_pushback, 9)==0) reqtype = REQ_WIFI;
-            else if (strncmp("GET /r", m_pushback, 6)==0) reqtype = -REQ_RELAY;
-            else if (strncmp("GET /mb", m_pushback, 7)==0) { reqtype = -REQ_M_BYTE; weboption2 = -1; bHasSecondValue = false; bCommaCount = 0; }
-            else if (strncmp("GET /mi", m_pushback, 7)==0) { reqtype = -REQ_M_INT; weboption2 = -1; bHasSecondValue = false; bCommaCount = 0; }
-//            else if (strncmp("GET /ma", m_pushback, 7)==0) reqtype = -REQ_M_ALL;
-            else if (strncmp("GET /mr", m_pushback, 7)==0) { reqtype = -REQ_M_RAW; weboption2 = -1; bHasSecondValue = false; bCommaCount = 0; }
-            else if (strncmp("GET /v", m_pushback, 6)==0) reqtype = -REQ_VERSION;
-            else if (strncmp("GET /d", m_pushback, 6)==0) { reqtype = -REQ_DATE; weboption2 = -1; weboption3 = -1; bCommaCount = 0; }
-            else if (strncmp("HTTP/1.", m_pushback, 7)==0) reqtype = -REQ_HTTP;
-            else if (strncmp("GET /sr", m_pushback, 7)==0) reqtype = -REQ_R_STATUS;
-            else if (strncmp("GET /sa", m_pushback, 7)==0) reqtype = -REQ_RA_STATUS;
-            else if (strncmp("GET /bp", m_pushback, 7)==0) reqtype = -REQ_BTN_PRESS;
-            else if (strncmp("GET /mf", m_pushback, 7)==0) reqtype = -REQ_FEEDING;
-            else if (strncmp("GET /mw", m_pushback, 7)==0) reqtype = -REQ_WATER;
-//            else if (strncmp("GET /cr", m_pushback, 7)==0) reqtype = -REQ_CAL_RELOAD;
-            else if (strncmp("GET /mt", m_pushback, 7)==0) reqtype = -REQ_ALARM_ATO;
-            else if (strncmp("GET /mo", m_pushback, 7)==0) reqtype = -REQ_ALARM_OVERHEAT;
-            else if (strncmp("GET /ml", m_pushback, 7)==0) reqtype = -REQ_ALARM_LEAK;
-            else if (strncmp("GET /l0", m_pushback, 7)==0) reqtype = -REQ_LIGHTSOFF;
-            else if (strncmp("GET /l1", m_pushback, 7)==0) reqtype = -REQ_LIGHTSON;
-            else if (strncmp("GET /boot", m_pushback, 9)==0) reqtype = REQ_REBOOT;
-            else if (strncmp("GET /po", m_pushback, 7)==0) { reqtype = -REQ_OVERRIDE; weboption2 = -1; bHasSecondValue = false; bCommaCount = 0; }
-#ifdef CUSTOM_VARIABLES
-            else if (strncmp("GET /cvar", m_pushback, 9)==0) { reqtype = -REQ_M_CVAR; weboption2 = -1; bHasSecondValue = false; bCommaCount = 0; }
-#endif
-            else if (strncmp("GET /cal", m_pushback, 8)==0) { reqtype = -REQ_CALIBRATION; weboption2 = -1; bHasSecondValue = false; bCommaCount = 0; }
-            else if (strncmp("GET /json", m_pushback, 9)==0) reqtype = REQ_JSON;
-            else if (strncmp("GET /favicon.ico", m_pushback, 16)==0) reqtype = REQ_FAVICON;
-#ifdef CLOUD_WIFI
-            else if (strncmp("cloud:", m_pushback, 6)==0)
-            {
-            	if (inStr==' ')
-            	{
-            		byte cloudstr[m_pushbackindex-6];
-            		for (int a=6; a<m_pushbackindex;a++)
-            		{
-            			cloudstr[a-6]=m_pushback[a];
-            		}
-            		cloudstr[sizeof(cloudstr)-1]=0;
-        			MQTTSubCallback("",cloudstr,sizeof(cloudstr));
-        			while(_wifiSerial->available()) _wifiSerial->read();
-            	}
-            	//reqtype = REQ_CLOUD;
-            }
-#endif // CLOUD_WIFI
-            //else reqtype = -REQ_UNKNOWN;
+			// no route matches this line, wait for the next one
+			if (inStr=='\n') m_pushbackindex=0;
+			return;
+		}
+		byte i=m_pushbackindex++;
+		boolean get=i>=5 && pgm_read_byte(&WebRoutes[routelo].path[0])=='G';
+		while (routelo<routehi && (byte)pgm_read_byte(&WebRoutes[routelo].path[i])<inStr) routelo++;
+		byte hi=routelo;
+		while (hi<routehi && (byte)pgm_read_byte(&WebRoutes[hi].path[i])==inStr) hi++;
+		routehi=hi;
+		if (routelo==routehi)
+		{
+			// "GET /" followed by an unknown path gets a 400, anything else is ignored
+			if (get) reqtype=REQ_UNKNOWN;
+			// the line ended on the mismatch, so the next one starts at position 0
+			if (inStr=='\n') m_pushbackindex=0;
+		}
+		else if (pgm_read_byte(&WebRoutes[routelo].path[i+1])==0)
+		{
+			reqtype=pgm_read_byte(&WebRoutes[routelo].reqtype);
+			weboption=0;
+			weboption2=-1;
+			weboption3=-1;
+			webnegoption=false;
+			bHasSecondValue=false;
+			bCommaCount=0;
+			m_lastchar=0;
+			etagstate=0;
+			etagmatch=0;
+			m_pushbackindex=0;
 		}
 	}
 }
@@ -243,6 +309,7 @@ void RA_Wifi::ProcessHTTP()
   if (usingAuth && !auth)
   {
 	  PROGMEMprint(SERVER_DENY);
+	  keepalive=false;
 	  m_pushbackindex=0;
 	  reqtype=0;
 	  weboption=0;
@@ -250,6 +317,8 @@ void RA_Wifi::ProcessHTTP()
 	  return;
   }
   if (webnegoption) weboption*=-1;
+  // collect the response in outbuffer, FlushOutput() below sends what is left
+  buffering=true;
 	switch ( reqtype )
 	{
 		case REQ_ROOT:
@@ -271,204 +340,7 @@ void RA_Wifi::ProcessHTTP()
 		case REQ_RA_STATUS:
 		case REQ_R_STATUS:
 		{
-			char temp[6];
-			int s=181;
-			//<RA><ID></ID><T1></T1><T2></T2><T3></T3><PH></PH><R></R><RON></RON><ROFF></ROFF><ATOLOW></ATOLOW><ATOHIGH></ATOHIGH><EM></EM><EM1></EM1><REM></REM><BID></BID><AF></AF><SF></SF></RA>
-			s += strlen(portalusername);
-			s += intlength(ReefAngel.Params.Temp[T1_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T2_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T3_PROBE]);
-#ifdef EXTRA_TEMP_PROBES
-			//<T4></T4><T5></T5><T6></T6>
-			s += 27;
-			s += intlength(ReefAngel.Params.Temp[T4_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T5_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T6_PROBE]);
-#endif
-			s += intlength(ReefAngel.Params.PH);
-			s += intlength(ReefAngel.EM);
-			s += intlength(ReefAngel.EM1);
-			s += intlength(ReefAngel.REM);
-			s += intlength(ReefAngel.AlertFlags);
-			s += intlength(ReefAngel.StatusFlags);
-			s += 2;  // one digit for each ATO
-			s += intlength(ReefAngel.Relay.RelayData);
-			s += intlength(ReefAngel.Relay.RelayMaskOn);
-			s += intlength(ReefAngel.Relay.RelayMaskOff);
-			s += intlength(ReefAngel.Board);
-#ifdef DisplayLEDPWM
-			s += 56;
-			//<PWMA></PWMA><PWMD></PWMD><PWMAO></PWMAO><PWMDO></PWMDO>
-#if defined(__SAM3X8E__)
-			s += intlength(ReefAngel.VariableControl.GetDaylightValue());
-			s += intlength(ReefAngel.VariableControl.GetActinicValue());
-			s += intlength(ReefAngel.VariableControl.GetDaylightOverrideValue());
-			s += intlength(ReefAngel.VariableControl.GetActinicOverrideValue());
-#else
-			s += intlength(ReefAngel.PWM.GetDaylightValue());
-			s += intlength(ReefAngel.PWM.GetActinicValue());
-			s += intlength(ReefAngel.PWM.GetDaylightOverrideValue());
-			s += intlength(ReefAngel.PWM.GetActinicOverrideValue());
-#endif
-#if defined RA_STAR || defined RA_EVOLUTION
-			s += 64;
-			//<PWMA2></PWMA2><PWMD2></PWMD2><PWMA2O></PWMA2O><PWMD2O></PWMD2O>
-#if defined(__SAM3X8E__)
-			s += intlength(ReefAngel.VariableControl.GetDaylight2Value());
-			s += intlength(ReefAngel.VariableControl.GetActinic2Value());
-			s += intlength(ReefAngel.VariableControl.GetDaylight2OverrideValue());
-			s += intlength(ReefAngel.VariableControl.GetActinic2OverrideValue());
-#else
-			s += intlength(ReefAngel.PWM.GetDaylight2Value());
-			s += intlength(ReefAngel.PWM.GetActinic2Value());
-			s += intlength(ReefAngel.PWM.GetDaylight2OverrideValue());
-			s += intlength(ReefAngel.PWM.GetActinic2OverrideValue());
-#endif
-#endif  // RA_STAR
-#endif  // DisplayLEDPWM
-#ifdef RelayExp
-			s += 296;
-			//<R0></R0><RON0></RON0><ROFF0></ROFF0><R1></R1><RON1></RON1><ROFF1></ROFF1><R2></R2><RON2></RON2><ROFF2></ROFF2><R3></R3><RON3></RON3><ROFF3></ROFF3><R4></R4><RON4></RON4><ROFF4></ROFF4><R5></R5><RON5></RON5><ROFF5></ROFF5><R6></R6><RON6></RON6><ROFF6></ROFF6><R7></R7><RON7></RON7><ROFF7></ROFF7>
-			for ( byte EID = 0; EID < MAX_RELAY_EXPANSION_MODULES; EID++ )
-			{
-				s += intlength(ReefAngel.Relay.RelayDataE[EID]);
-				s += intlength(ReefAngel.Relay.RelayMaskOnE[EID]);
-				s += intlength(ReefAngel.Relay.RelayMaskOffE[EID]);
-			}
-#endif  // RelayExp
-#ifdef PWMEXPANSION
-			s += 192;
-			//<PWME0></PWME0><PWME1></PWME1><PWME2></PWME2><PWME3></PWME3><PWME4></PWME4><PWME5></PWME5><PWME0O></PWME0O><PWME1O></PWME1O><PWME2O></PWME2O><PWME3O></PWME3O><PWME4O></PWME4O><PWME5O></PWME5O>
-#if defined(__SAM3X8E__)
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.GetChannelValue(EID));
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.GetChannelOverrideValue(EID));
-#else
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.GetChannelValue(EID));
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.GetChannelOverrideValue(EID));
-#endif
-#endif  // PWMEXPANSION
-#ifdef SIXTEENCHPWMEXPANSION
-			s += 664;
-			//<SCPWME0></SCPWME0><SCPWME1></SCPWME1><SCPWME2></SCPWME2><SCPWME3></SCPWME3><SCPWME4></SCPWME4><SCPWME5></SCPWME5><SCPWME6></SCPWME6><SCPWME7></SCPWME7><SCPWME8></SCPWME8><SCPWME9></SCPWME9><SCPWME10></SCPWME10><SCPWME11></SCPWME11><SCPWME12></SCPWME12><SCPWME13></SCPWME13><SCPWME14></SCPWME14><SCPWME15></SCPWME15><SCPWME0O></SCPWME0O><SCPWME1O></SCPWME1O><SCPWME2O></SCPWME2O><SCPWME3O></SCPWME3O><SCPWME4O></SCPWME4O><SCPWME5O></SCPWME5O><SCPWME6O></SCPWME6O><SCPWME7O></SCPWME7O><SCPWME8O></SCPWME8O><SCPWME9O></SCPWME9O><SCPWME10O></SCPWME10O><SCPWME11O></SCPWME11O><SCPWME12O></SCPWME12O><SCPWME13O></SCPWME13O><SCPWME14O></SCPWME14O><SCPWME15O></SCPWME15O>
-#if defined(__SAM3X8E__)
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.Get16ChannelValue(EID));
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.Get16ChannelOverrideValue(EID));
-#else
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.Get16ChannelValue(EID));
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.Get16ChannelOverrideValue(EID));
-#endif
-#endif  // SIXTEENCHPWMEXPANSION
-#ifdef RFEXPANSION
-			s += 181;
-			//<RFM></RFM><RFS></RFS><RFD></RFD><RFW></RFW><RFRB></RFRB><RFR></RFR><RFG></RFG><RFB></RFB><RFI></RFI><RFWO></RFWO><RFRBO></RFRBO><RFRO></RFRO><RFGO></RFGO><RFBO></RFBO><RFIO></RFIO>
-			for ( byte EID = 0; EID < RF_CHANNELS; EID++ ) s += intlength(ReefAngel.RF.GetChannel(EID));
-			for ( byte EID = 0; EID < RF_CHANNELS; EID++ ) s += intlength(ReefAngel.RF.GetOverrideChannel(EID));
-			s += intlength(ReefAngel.RF.Mode);
-			s += intlength(ReefAngel.RF.Speed);
-			s += intlength(ReefAngel.RF.Duration);
-#endif  // RFEXPANSION
-#ifdef AI_LED
-			s += 76;
-			//<AIW></AIW><AIB></AIB><AIRB></AIRB><AIWO></AIWO><AIBO></AIBO><AIRBO></AIRBO>
-			for ( byte EID = 0; EID < AI_CHANNELS; EID++ ) s += intlength(ReefAngel.AI.GetChannel(EID));
-			for ( byte EID = 0; EID < AI_CHANNELS; EID++ ) s += intlength(ReefAngel.AI.GetOverrideChannel(EID));
-#endif  // AI_LED
-#ifdef SALINITYEXPANSION
-			s += 11;
-			//<SAL></SAL>
-			s += intlength(ReefAngel.Params.Salinity);
-#endif  // SALINITYEXPANSION
-#ifdef ORPEXPANSION
-			s += 11;
-			//<ORP></ORP>
-			s += intlength(ReefAngel.Params.ORP);
-#endif  // ORPEXPANSION
-#ifdef PHEXPANSION
-			s += 11;
-			//<PHE></PHE>
-			s += intlength(ReefAngel.Params.PHExp);
-#endif  // PHEXPANSION
-#if defined WATERLEVELEXPANSION
-			s += 9;
-			//<WL></WL>
-			s += intlength(ReefAngel.WaterLevel.GetLevel());
-#endif  // WATERLEVELEXPANSION
-#if defined MULTIWATERLEVELEXPANSION
-			s += 44;
-			//<WL1></WL1><WL2></WL2><WL3></WL3><WL4></WL4>
-			for ( byte EID = 1; EID < WATERLEVEL_CHANNELS; EID++ ) s += intlength(ReefAngel.WaterLevel.GetLevel(EID));
-#endif  // MULTIWATERLEVELEXPANSION
-#ifdef HUMIDITYEXPANSION
-			s += 11;
-			//<HUM></HUM>
-			s += intlength(ReefAngel.Humidity.GetLevel());
-#endif  // HUMIDITYEXPANSION
-#ifdef PAREXPANSION
-			s += 11;
-			//<PAR></PAR>
-			s += intlength(ReefAngel.PAR.GetLevel());
-#endif  // PAREXPANSION
-#ifdef OZONEEXPANSION
-			s += 11;
-			//<OZO></OZO>
-			s += intlength(ReefAngel.Params.Ozone);
-#endif//OZONEEXPANSION
-#ifdef CO2EXPANSION
-    s += 28;  // Adding fixed length for <CO2></CO2><CO2HUM></CO2HUM> tags
-    // Add the length of the integer values as string
-    s += intlength(ReefAngel.Co2.getCO2Level());
-    s += intlength(ReefAngel.Co2.getHumidity());
-#endif // CO2EXPANSION
-#ifdef DCPUMPCONTROL
-			s += 44;
-			//<DCM></DCM><DCS></DCS><DCD></DCD><DCT></DCT>
-			s += intlength(ReefAngel.DCPump.Mode);
-			s += intlength(ReefAngel.DCPump.Speed);
-			s += intlength(ReefAngel.DCPump.Duration);
-			s += intlength(ReefAngel.DCPump.Threshold);
-#endif  // DCPUMPCONTROL
-#ifdef IOEXPANSION
-			s += 9;
-			//<IO></IO>
-			s += intlength(ReefAngel.IO.GetChannel());
-#endif  // IOEXPANSION
-#ifdef CUSTOM_VARIABLES
-			s += 72;
-			//<C0></C0><C1></C1><C2></C2><C3></C3><C4></C4><C5></C5><C6></C6><C7></C7>
-			for ( byte EID = 0; EID < 8; EID++ ) s += intlength(ReefAngel.CustomVar[EID]);
-#endif  // CUSTOM_VARIABLES
-#ifdef LEAKDETECTOREXPANSION
-			s += 13;
-			//<LEAK></LEAK>
-			s += intlength(ReefAngel.IsLeakDetected());
-#endif  // LEAKDETECTOREXPANSION
-#if defined RA_STAR || defined RA_EVOLUTION
-			s += 15;
-			//<ALARM></ALARM>
-			s += intlength(ReefAngel.AlarmInput.IsActive());
-#endif  // RA_STAR
-#ifdef ENABLE_ATO_LOGGING
-			if ( reqtype == REQ_RA_STATUS )
-			{
-				// we send all the ato logging events both high & low
-				/*
-				The XML code will be like this.  This is 1 event.  There are 8 events total (4 low / 4 high).
-				<AL#ON>DWORD</AL#ON>
-				<AL#OFF>DWORD</AL#OFF>
-				Each event is 40 bytes (32 bytes for text, 8 bytes for dword values total)
-				*/
-				s += 320;
-			}
-#endif  // ENABLE_ATO_LOGGING
-			PrintHeader(s,1);
-#ifdef ENABLE_ATO_LOGGING
-			if ( reqtype == REQ_RA_STATUS )
-				SendXMLData(true);
-			else
-				SendXMLData();
-#else
-			SendXMLData();
-#endif  // ENABLE_ATO_LOGGING
+			SendStatus(reqtype);
 			break;
 		}  // REQ_RELAY
 		case REQ_M_BYTE:
@@ -476,6 +348,8 @@ void RA_Wifi::ProcessHTTP()
 		case REQ_M_CVAR:
 		{
 			int s;
+			// sized by hand, so the connection isn't reused after it
+			keepalive=false;
 
 			// if memory location is > 800 it means app is trying to pull/set old memory location.
 			// we decrease 600 to start using new memory map
@@ -577,6 +451,8 @@ void RA_Wifi::ProcessHTTP()
 		case REQ_OVERRIDE:
 		{
 			int s;
+			// sized by hand, so the connection isn't reused after it
+			keepalive=false;
 
 			if ( bHasSecondValue && (weboption2 < OVERRIDE_CHANNELS) )
 			{
@@ -608,6 +484,8 @@ void RA_Wifi::ProcessHTTP()
 		case REQ_M_RAW:
 		{
 			int s = 11;  // start with the base size of the mem tags
+			// sized by hand, so the connection isn't reused after it
+			keepalive=false;
 
 			// default to Main memory locations
 			int memStart = VarsStart;
@@ -650,6 +528,8 @@ void RA_Wifi::ProcessHTTP()
 		case REQ_VERSION:
 		{
 			int s = 7;
+			// sized by hand, so the connection isn't reused after it
+			keepalive=false;
 			s += strlen(ReefAngel_Version);
 			PrintHeader(s,1);
 			print("<V>"ReefAngel_Version"</V>");
@@ -659,6 +539,9 @@ void RA_Wifi::ProcessHTTP()
 		{
 			uint8_t s = 10;
 			uint8_t hr, min, mon, mday;
+			time_t n;
+			// sized by hand, so the connection isn't reused after it
+			keepalive=false;
 			if ( weboption > -1 )
 			{
 				/*
@@ -693,9 +576,10 @@ void RA_Wifi::ProcessHTTP()
 			{
 				// sending controller date/time
 				// 51 = rest of xml tags
-				// 12 = data being sent (already have 3 extra in s)
 				//  7  = base xml tags (open & close d)
-				s += 60;
+				// plus the digits actually sent, hours and days are not zero padded
+				n = now();
+				s = 58 + intlength(hour(n)) + intlength(minute(n)) + intlength(month(n)) + intlength(day(n)) + intlength(year(n));
 			}
 			PrintHeader(s,1);
 			PROGMEMprint(XML_DATE_OPEN);
@@ -705,7 +589,6 @@ void RA_Wifi::ProcessHTTP()
 			}
 			else if ( weboption == -2 )
 			{
-				time_t n = now();
 				print("<HR>");
 				print(hour(n), DEC);
 				print("</HR><MIN>");
@@ -843,6 +726,7 @@ void RA_Wifi::ProcessHTTP()
 		{
 			// Reboot
 			ModeResponse(true);
+			FlushOutput();
 			while(1);
 			break;
 		}
@@ -871,177 +755,40 @@ void RA_Wifi::ProcessHTTP()
 		}
 #ifndef RA_STANDARD
 		case REQ_JSON:
+		case REQ_BINARY:
+		case REQ_SCHEMA:
 		{
-			char temp[6];
-			int s=152;
-			//{"json":{"ID":"","T1":"","T2":"","T3":"","PH":"","R":"","RON":"","ROFF":"","ATOLOW":"","ATOHIGH":"","EM":"","EM1":"","REM":"","BID":"","AF":"","SF":""}}
-			s += strlen(portalusername);
-			s += intlength(ReefAngel.Params.Temp[T1_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T2_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T3_PROBE]);
-#ifdef EXTRA_TEMP_PROBES
-			//,"T1":"","T2":"","T3":""
-			s += 24;
-			s += intlength(ReefAngel.Params.Temp[T4_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T5_PROBE]);
-			s += intlength(ReefAngel.Params.Temp[T6_PROBE]);
-#endif
-			s += intlength(ReefAngel.Params.PH);
-			s += intlength(ReefAngel.EM);
-			s += intlength(ReefAngel.EM1);
-			s += intlength(ReefAngel.REM);
-			s += intlength(ReefAngel.AlertFlags);
-			s += intlength(ReefAngel.StatusFlags);
-			s += 2;  // one digit for each ATO
-			s += intlength(ReefAngel.Relay.RelayData);
-			s += intlength(ReefAngel.Relay.RelayMaskOn);
-			s += intlength(ReefAngel.Relay.RelayMaskOff);
-			s += intlength(ReefAngel.Board);
-#ifdef DisplayLEDPWM
-			s += 42;
-			//,"PWMA":"","PWMD":"","PWMAO":"","PWMDO":""
-#if defined(__SAM3X8E__)
-			s += intlength(ReefAngel.VariableControl.GetDaylightValue());
-			s += intlength(ReefAngel.VariableControl.GetActinicValue());
-			s += intlength(ReefAngel.VariableControl.GetDaylightOverrideValue());
-			s += intlength(ReefAngel.VariableControl.GetActinicOverrideValue());
-#else
-			s += intlength(ReefAngel.PWM.GetDaylightValue());
-			s += intlength(ReefAngel.PWM.GetActinicValue());
-			s += intlength(ReefAngel.PWM.GetDaylightOverrideValue());
-			s += intlength(ReefAngel.PWM.GetActinicOverrideValue());
-#endif
-#if defined RA_STAR || defined RA_EVOLUTION
-			s += 46;
-			//,"PWMA2":"","PWMD2":"","PWMA2O":"","PWMD2O":""
-#if defined(__SAM3X8E__)
-			s += intlength(ReefAngel.VariableControl.GetDaylight2Value());
-			s += intlength(ReefAngel.VariableControl.GetActinic2Value());
-			s += intlength(ReefAngel.VariableControl.GetDaylight2OverrideValue());
-			s += intlength(ReefAngel.VariableControl.GetActinic2OverrideValue());
-#else
-			s += intlength(ReefAngel.PWM.GetDaylight2Value());
-			s += intlength(ReefAngel.PWM.GetActinic2Value());
-			s += intlength(ReefAngel.PWM.GetDaylight2OverrideValue());
-			s += intlength(ReefAngel.PWM.GetActinic2OverrideValue());
-#endif
-#endif  // RA_STAR
-#endif  // DisplayLEDPWM
-#ifdef RelayExp
-			s += 232;
-			//,"R1":"","RON1":"","ROFF1":"","R2":"","RON2":"","ROFF2":"","R3":"","RON3":"","ROFF3":"","R4":"","RON4":"","ROFF4":"","R5":"","RON5":"","ROFF5":"","R6":"","RON6":"","ROFF6":"","R7":"","RON7":"","ROFF7":"","R8":"","RON8":"","ROFF8":""
-			for ( byte EID = 0; EID < MAX_RELAY_EXPANSION_MODULES; EID++ )
-			{
-				s += intlength(ReefAngel.Relay.RelayDataE[EID]);
-				s += intlength(ReefAngel.Relay.RelayMaskOnE[EID]);
-				s += intlength(ReefAngel.Relay.RelayMaskOffE[EID]);
-			}
-#endif  // RelayExp
-#ifdef PWMEXPANSION
-			s += 138;
-			//,"PWME0":"","PWME1":"","PWME2":"","PWME3":"","PWME4":"","PWME5":"","PWME0O":"","PWME1O":"","PWME2O":"","PWME3O":"","PWME4O":"","PWME5O":""
-#if defined(__SAM3X8E__)
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.GetChannelValue(EID));
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.GetChannelOverrideValue(EID));
-#else
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.GetChannelValue(EID));
-			for ( byte EID = 0; EID < PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.GetChannelOverrideValue(EID));
-#endif
-#endif  // PWMEXPANSION
-#ifdef SIXTEENCHPWMEXPANSION
-			s += 444;
-			//,"SCPWME0":"","SCPWME1":"","SCPWME2":"","SCPWME3":"","SCPWME4":"","SCPWME5":"","SCPWME6":"","SCPWME7":"","SCPWME8":"","SCPWME9":"","SCPWME10":"","SCPWME11":"","SCPWME12":"","SCPWME13":"","SCPWME14":"","SCPWME15":"","SCPWME0O":"","SCPWME1O":"","SCPWME2O":"","SCPWME3O":"","SCPWME4O":"","SCPWME5O":"","SCPWME6O":"","SCPWME7O":"","SCPWME8O":"","SCPWME9O":"","SCPWME10O":"","SCPWME11O":"","SCPWME12O":"","SCPWME13O":"","SCPWME14O":"","SCPWME15O":""
-#if defined(__SAM3X8E__)
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.Get16ChannelValue(EID));
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.VariableControl.Get16ChannelOverrideValue(EID));
-#else
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.Get16ChannelValue(EID));
-			for ( byte EID = 0; EID < SIXTEENCH_PWM_EXPANSION_CHANNELS; EID++ ) s += intlength(ReefAngel.PWM.Get16ChannelOverrideValue(EID));
-#endif
-#endif  // SIXTEENCHPWMEXPANSION
-#ifdef RFEXPANSION
-			s += 143;
-			//,"RFM":"","RFS":"","RFD":"","RFW":"","RFRB":"","RFR":"","RFG":"","RFB":"","RFI":"","RFWO":"","RFRBO":"","RFRO":"","RFGO":"","RFBO":"","RFIO":""
-			for ( byte EID = 0; EID < RF_CHANNELS; EID++ ) s += intlength(ReefAngel.RF.GetChannel(EID));
-			for ( byte EID = 0; EID < RF_CHANNELS; EID++ ) s += intlength(ReefAngel.RF.GetOverrideChannel(EID));
-			s += intlength(ReefAngel.RF.Mode);
-			s += intlength(ReefAngel.RF.Speed);
-			s += intlength(ReefAngel.RF.Duration);
-#endif  // RFEXPANSION
-#ifdef AI_LED
-			s += 59;
-			//,"AIW":"","AIB":"","AIRB":"","AIWO":"","AIBO":"","AIRBO":""
-			for ( byte EID = 0; EID < AI_CHANNELS; EID++ ) s += intlength(ReefAngel.AI.GetChannel(EID));
-			for ( byte EID = 0; EID < AI_CHANNELS; EID++ ) s += intlength(ReefAngel.AI.GetOverrideChannel(EID));
-#endif  // AI_LED
-#ifdef SALINITYEXPANSION
-			s += 9;
-			//,"SAL":""
-			s += intlength(ReefAngel.Params.Salinity);
-#endif  // SALINITYEXPANSION
-#ifdef ORPEXPANSION
-			s += 9;
-			//,"ORP":""
-			s += intlength(ReefAngel.Params.ORP);
-#endif  // ORPEXPANSION
-#ifdef PHEXPANSION
-			s += 9;
-			//,"PHE":""
-			s += intlength(ReefAngel.Params.PHExp);
-#endif  // PHEXPANSION
-#if defined WATERLEVELEXPANSION || defined MULTIWATERLEVELEXPANSION
-			s += 44;
-			//,"WL":"","WL1":"","WL2":"","WL3":"","WL4":""
-			s += intlength(ReefAngel.WaterLevel.GetLevel());
-			for ( byte EID = 1; EID < WATERLEVEL_CHANNELS; EID++ ) s += intlength(ReefAngel.WaterLevel.GetLevel(EID));
-#endif  // WATERLEVELEXPANSION || MULTIWATERLEVELEXPANSION
-#ifdef HUMIDITYEXPANSION
-			s += 9;
-			//,"HUM":""
-			s += intlength(ReefAngel.Humidity.GetLevel());
-#endif  // HUMIDITYEXPANSION
-#ifdef PAREXPANSION
-			s += 9;
-			//,"PAR":""
-			s += intlength(ReefAngel.PAR.GetLevel());
-#endif  // PAREXPANSION
-#ifdef DCPUMPCONTROL
-			s += 36;
-			//,"DCM":"","DCS":"","DCD":"","DCT":""
-			s += intlength(ReefAngel.DCPump.Mode);
-			s += intlength(ReefAngel.DCPump.Speed);
-			s += intlength(ReefAngel.DCPump.Duration);
-			s += intlength(ReefAngel.DCPump.Threshold);
-#endif  // DCPUMPCONTROL
-#ifdef IOEXPANSION
-			s += 8;
-			//,"IO":""
-			s += intlength(ReefAngel.IO.GetChannel());
-#endif  // IOEXPANSION
-#ifdef CUSTOM_VARIABLES
-			s += 64;
-			//,"C0":"","C1":"","C2":"","C3":"","C4":"","C5":"","C6":"","C7":""
-			for ( byte EID = 0; EID < 8; EID++ ) s += intlength(ReefAngel.CustomVar[EID]);
-#endif  // CUSTOM_VARIABLES
-#ifdef LEAKDETECTOREXPANSION
-			s += 10;
-			//,"LEAK":""
-			s += intlength(ReefAngel.IsLeakDetected());
-#endif  // LEAKDETECTOREXPANSION
-#if defined RA_STAR || defined RA_EVOLUTION
-			s += 11;
-			//,"ALARM":""
-			s += intlength(ReefAngel.AlarmInput.IsActive());
-#endif  // RA_STAR
-			PrintHeader(s,2);
-			SendJSONData();
+			SendStatus(reqtype);
 			break;
 		}  // REQ_JSON
 #endif // RA_STANDARD
 
-		default:
+#ifdef ETH_WIZ5100
+		case REQ_EVENTS:
+		{
+			// ProcessEthernet hands the connection over to the event stream
+			if (!SpareSocket())
+			{
+				PROGMEMprint(SERVER_BUSY);
+				keepalive=false;
+				break;
+			}
+			PROGMEMprint(SERVER_EVENTS);
+			ReefAngel.InvalidateParams(PARAM_EVENTS);
+			eventstream=true;
+			break;
+		}
+#endif  // ETH_WIZ5100
 		case REQ_UNKNOWN:
 		{
+			PROGMEMprint(SERVER_BAD_REQUEST);
+			keepalive=false;
+			break;
+		}
+		default:
+		{
+			// nothing was sent, so the connection can't be reused
+			keepalive=false;
 			//P(WebBodyMsg) = SERVER_UKNOWN;
 			//WebResponse(WebBodyMsg, sizeof(WebBodyMsg) - 1);
 			break;
@@ -1051,25 +798,41 @@ void RA_Wifi::ProcessHTTP()
 	ReefAngel.WDTReset();
 #endif  // defined WDT || defined WDT_FORCE
 
+	FlushOutput();
+	buffering=false;
 	m_pushbackindex=0;
     reqtype=0;
     weboption=0;
     webnegoption=false;
 }
 
-void RA_Wifi::PrintHeader(int s, byte type)
+void RA_Wifi::FlushOutput()
+{
+#ifndef ETH_WIZ5100
+	if (outlength) _wifiSerial->write(outbuffer, outlength);
+#endif  // ETH_WIZ5100
+	outlength=0;
+}
+
+void RA_Wifi::PrintHeader(int s, byte type, boolean etag /*= false*/)
 {
 	PROGMEMprint(SERVER_HEADER1);
+	PROGMEMprint(keepalive ? SERVER_KEEPALIVE : SERVER_CLOSE);
+	if (etag) PrintETag();
+	PROGMEMprint(SERVER_CONTENT_TYPE);
 	switch(type)
 	{
 	  case 0:
-	    print("html");
+	    print("text/html");
 	    break;
 	  case 1:
-	    print("xml");
+	    print("text/xml");
 	    break;
 	  case 2:
-	    print("json");
+	    print("text/json");
+	    break;
+	  case 3:
+	    print("application/octet-stream");
 	    break;
 	}
 
@@ -1078,6 +841,47 @@ void RA_Wifi::PrintHeader(int s, byte type)
 	PROGMEMprint(SERVER_HEADER3);
 }
 
+void RA_Wifi::PrintETag()
+{
+	PROGMEMprint(SERVER_ETAG);
+	print(etag, HEX);
+	print("\"\r\n");
+}
+
+void RA_Wifi::ParseHeader(char c)
+{
+	// Picks the first tag out of an If-None-Match header
+	// etagstate: 0 looking for the header, 1 reading the tag, 2 tag read
+	if (etagstate==1)
+	{
+		if (isxdigit(c))
+		{
+			ifnonematch<<=4;
+			ifnonematch|=isdigit(c) ? c-'0' : tolower(c)-'a'+10;
+			etagmatch++;
+		}
+		else if ((c=='"' && etagmatch) || c=='\r' || c==',')
+		{
+			etagstate=2;
+		}
+	}
+	else if (etagstate==0 && MatchHTTP(HTTP_IF_NONE_MATCH, etagmatch, c))
+	{
+		etagstate=1;
+		etagmatch=0;
+		ifnonematch=0;
+	}
+}
+
+boolean RA_Wifi::MatchHTTP(const char *pattern, byte &index, char c)
+{
+	// Advances index through a lower case PROGMEM pattern, true once all of it was seen
+	c=tolower(c);
+	if (c==(char)pgm_read_byte(pattern+index)) index++;
+	else index=(c==(char)pgm_read_byte(pattern)) ? 1 : 0;
+	return pgm_read_byte(pattern+index)==0;
+}
+
 char RA_Wifi::GetC(int c)
 {
 	return pgm_read_byte(c+EncodingChars);
@@ -1111,6 +915,57 @@ void RA_Wifi::WifiAuthentication(char* userpass)
 	usingAuth=true;
 }
 
+void RA_Wifi::SendStatus(byte req)
+{
+	// The serializer runs twice, first with the output only counted and hashed for the
+	// Content-Length and ETag, and then for real behind the header.
+	// A client that already has this body gets a 304 instead of the second run.
+	// The counting run still happens for a 304: the tag has to come from the body,
+	// because /sa also carries the ATO log and readings the parameter registry doesn't
+	// track, and a change counter would hand out stale 304s for those.
+	measuring=true;
+	measured=0;
+	etag=2166136261UL;
+	for ( byte pass = 0; pass < 2; pass++ )
+	{
+		if ( pass == 1 )
+		{
+			measuring=false;
+			if ( etagstate != 0 && etagmatch > 0 && ifnonematch == etag )
+			{
+				PROGMEMprint(SERVER_NOT_MODIFIED);
+				PROGMEMprint(keepalive ? SERVER_KEEPALIVE : SERVER_CLOSE);
+				PrintETag();
+				print("\r\n");
+				return;
+			}
+			if ( req == REQ_BINARY )
+				PrintHeader(measured,3,true);
+			else if ( req == REQ_JSON || req == REQ_SCHEMA )
+				PrintHeader(measured,2,true);
+			else
+				PrintHeader(measured,1,true);
+		}
+		switch ( req )
+		{
+#ifndef RA_STANDARD
+			case REQ_JSON:
+				SendJSONData();
+				break;
+			case REQ_BINARY:
+				SendBinaryData();
+				break;
+			case REQ_SCHEMA:
+				SendSchemaJSON();
+				break;
+#endif  // RA_STANDARD
+			default:
+				SendXMLData(req == REQ_RA_STATUS);
+				break;
+		}
+	}
+}
+
 void RA_Wifi::SendXMLData(bool fAtoLog /*= false*/)
 {
 	// This function is used for sending the XML data on the wifi interface
@@ -1459,7 +1314,7 @@ void RA_Wifi::SendXMLData(bool fAtoLog /*= false*/)
 			PROGMEMprint(XML_RE_ON);
 			PROGMEMprint(XML_CLOSE_TAG);
 			// zero out memory after sent
-			InternalMemory.write_dword(loc, 0);
+			if (!measuring) InternalMemory.write_dword(loc, 0);
 			// low stop time
 			loc += ATOEventOffStart;
 			PROGMEMprint(XML_ATOLOW_LOG_OPEN);
@@ -1472,7 +1327,7 @@ void RA_Wifi::SendXMLData(bool fAtoLog /*= false*/)
 			PROGMEMprint(XML_RE_OFF);
 			PROGMEMprint(XML_CLOSE_TAG);
 			// zero out memory after sent
-			InternalMemory.write_dword(loc, 0);
+			if (!measuring) InternalMemory.write_dword(loc, 0);
 			// print ato high event
 			// high start time
 			loc = (b * ATOEventSize) + ATOEventStart + (ATOEventSize * MAX_ATO_LOG_EVENTS);
@@ -1486,7 +1341,7 @@ void RA_Wifi::SendXMLData(bool fAtoLog /*= false*/)
 			PROGMEMprint(XML_RE_ON);
 			PROGMEMprint(XML_CLOSE_TAG);
 			// zero out memory after sent
-			InternalMemory.write_dword(loc, 0);
+			if (!measuring) InternalMemory.write_dword(loc, 0);
 			// high stop time
 			loc += ATOEventOffStart;
 			PROGMEMprint(XML_ATOHIGH_LOG_OPEN);
@@ -1499,7 +1354,7 @@ void RA_Wifi::SendXMLData(bool fAtoLog /*= false*/)
 			PROGMEMprint(XML_RE_OFF);
 			PROGMEMprint(XML_CLOSE_TAG);
 			// zero out memory after sent
-			InternalMemory.write_dword(loc, 0);
+			if (!measuring) InternalMemory.write_dword(loc, 0);
 		}
 		AtoEventCount = 0;
 	}
@@ -1702,6 +1557,9 @@ void RA_Wifi::SendJSONData()
 	SendSingleJSON(JSON_RFB,ReefAngel.RF.GetOverrideChannel(4),"O");
 	SendSingleJSON(JSON_RFI,ReefAngel.RF.GetOverrideChannel(5),"O");
 #endif  // RFEXPANSION
+#ifdef REFRESH_PROFILER
+	SendProfilerJSON();
+#endif  // REFRESH_PROFILER
 	PROGMEMprint(JSON_CLOSE);
 }
 
@@ -1725,6 +1583,60 @@ void RA_Wifi::SendSingleJSON(const char str[], char* value)
 	print("\"");
 }
 
+#ifdef REFRESH_PROFILER
+void RA_Wifi::SendProfilerJSON()
+{
+	// Each stage is sent as "min,avg,max" in microseconds
+	print(",\"");
+	PROGMEMprint(JSON_LOOPMAX);
+	print("\":\"");
+	print(ReefAngel.Profiler.LoopMax);
+	print("\",\"");
+	PROGMEMprint(JSON_OVERRUN);
+	print("\":\"");
+	print(ReefAngel.Profiler.Overruns);
+	print("\"");
+	for ( byte a = 0; a < PROFILE_STAGES; a++ )
+	{
+		print(",\"");
+		PROGMEMprint(JSON_PROF);
+		print(a);
+		print("\":\"");
+		print(ReefAngel.Profiler.GetMin(a));
+		print(",");
+		print(ReefAngel.Profiler.GetAvg(a));
+		print(",");
+		print(ReefAngel.Profiler.GetMax(a));
+		print("\"");
+	}
+}
+#endif  // REFRESH_PROFILER
+
+void RA_Wifi::SendBinaryData()
+{
+	byte size=ReefAngel.StatusRecordSize();
+	for ( byte a = 0; a < size; a++ ) write(ReefAngel.StatusRecordByte(a));
+}
+
+void RA_Wifi::SendSchemaJSON()
+{
+	// {"v":1,"b":["ATOLOW",...],"i":["T1",...]}
+	byte bytes=ReefAngel.StatusRecordByte(1);
+	byte ints=ReefAngel.StatusRecordByte(2);
+	print("{\"v\":");
+	print(STATUS_RECORD_VERSION, DEC);
+	print(",\"b\":[");
+	for ( byte a = 0; a < bytes+ints; a++ )
+	{
+		if ( a == bytes ) print("],\"i\":[");
+		else if ( a > 0 ) print(",");
+		print("\"");
+		PROGMEMprint(ReefAngel.ParamName(a));
+		print("\"");
+	}
+	print("]}");
+}
+
 #endif // RA_STANDARD
 
 void RA_Wifi::ProcessSerial()
@@ -143,9 +143,21 @@ const char XML_MODE_CLOSE[] PROGMEM = "</MODE>";
 const char XML_OK[] PROGMEM = "OK";
 const char XML_ERR[] PROGMEM = "ERR";
 
-const char SERVER_HEADER1[] PROGMEM = "HTTP/1.1 200 OK\r\nServer: reefangel.com\r\nCache-Control: no-store, no-cache, must-revalidate\r\nPragma: no-cache\r\nAccess-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: GET\r\nConnection: close\r\nContent-Type: text/";
+const char SERVER_HEADER1[] PROGMEM = "HTTP/1.1 200 OK\r\nServer: reefangel.com\r\nCache-Control: no-cache, must-revalidate\r\nPragma: no-cache\r\nAccess-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: GET\r\n";
+const char SERVER_NOT_MODIFIED[] PROGMEM = "HTTP/1.1 304 Not Modified\r\nServer: reefangel.com\r\n";
+const char SERVER_CLOSE[] PROGMEM = "Connection: close\r\n";
+const char SERVER_KEEPALIVE[] PROGMEM = "Connection: keep-alive\r\n";
+const char SERVER_EVENTS[] PROGMEM = "HTTP/1.1 200 OK\r\nServer: reefangel.com\r\nCache-Control: no-cache\r\nAccess-Control-Allow-Origin: *\r\nContent-Type: text/event-stream\r\n\r\n";
+const char SERVER_ETAG[] PROGMEM = "ETag: \"";
+const char SERVER_CONTENT_TYPE[] PROGMEM = "Content-Type: ";
 const char SERVER_HEADER2[] PROGMEM = "\r\nContent-Length: ";
 const char SERVER_HEADER3[] PROGMEM = "\r\n\r\n";
+const char SERVER_BAD_REQUEST[] PROGMEM = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+const char SERVER_BUSY[] PROGMEM = "HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nRetry-After: 60\r\nContent-Length: 0\r\n\r\n";
+const char HTTP_END[] PROGMEM = "\r\n\r\n";
+const char HTTP_CLOSE[] PROGMEM = "connection: close";
+const char HTTP_10[] PROGMEM = "http/1.0";
+const char HTTP_IF_NONE_MATCH[] PROGMEM = "if-none-match:";
 const char SERVER_DENY[] PROGMEM = "HTTP/1.1 401 Access Denied\r\nWWW-Authenticate: Basic realm=Reef Angel Controller\r\nContent-Length: 0\r\n";
 const char SERVER_DEFAULT[] PROGMEM = "<h1>Reef Angel Controller Web Server</h1>";
 
@@ -275,6 +287,9 @@ const char JSON_CEXP4[] PROGMEM = "CEXP4";
 const char JSON_CEXP5[] PROGMEM = "CEXP5";
 const char JSON_CEXP6[] PROGMEM = "CEXP6";
 const char JSON_CEXP7[] PROGMEM = "CEXP7";
+const char JSON_PROF[] PROGMEM = "PROF";
+const char JSON_LOOPMAX[] PROGMEM = "LMAX";
+const char JSON_OVERRUN[] PROGMEM = "LOVR";
 const char JSON_CLOSE[] PROGMEM = "}}";
 
 #endif // RA_STANDARD
@@ -306,9 +321,15 @@ const char JSON_CLOSE[] PROGMEM = "}}";
 #define REQ_CALIBRATION	24		// Calibration
 #define REQ_JSON		25		// JSON export
 #define REQ_FAVICON		26		// favicon
+#define REQ_CLOUD		27		// Cloud command from the wifi attachment
+#define REQ_BINARY		28		// Binary status record
+#define REQ_SCHEMA		29		// Binary status record layout
+#define REQ_EVENTS		30		// Stream of changed parameters (server-sent events)
 #define REQ_HTTP		127		// HTTP get request from  external server
 #define REQ_UNKNOWN		128	 	// Unknown request
 
+#define WIFI_OUTPUT_BUFFER	64		// HTTP responses are written out in blocks of this size
+
 #define P(name)   static const char name[] PROGMEM
 //const char SERVER_RA[] PROGMEM = "<script language='javascript' src='http://www.reefangel.com/wifi/ra1.js'></script>";
 const char SERVER_RA[] PROGMEM = "<object type=text/html data=http://www.reefangel.com/wifi3/content.html width=100% height=98%></object>";
@@ -504,13 +525,6 @@ const char BannerCo2Hum[] PROGMEM = "&Co2Hum=";
 //};
 #endif  // wifi
 
-// Moved from Globals.h to break circular dependency
-#if defined wifi || defined CLOUD_WIFI || defined ETH_WIZ5100 || defined(__AVR_ATmega2560__) 
-#define NumParamByte	94
-#define NumParamInt		22
-static PROGMEM const char * const param_items_byte[] = {JSON_ATOLOW, JSON_ATOHIGH, JSON_EM, JSON_EM1, JSON_REM, JSON_BOARDID, JSON_ALERTFLAG, JSON_STATUSFLAG, JSON_PWMD, JSON_PWMA, JSON_PWMDO, JSON_PWMAO, JSON_R1, JSON_ROFF1, JSON_RON1, JSON_R2, JSON_ROFF2, JSON_RON2, JSON_R3, JSON_ROFF3, JSON_RON3, JSON_R4, JSON_ROFF4, JSON_RON4, JSON_R5, JSON_ROFF5, JSON_RON5, JSON_R6, JSON_ROFF6, JSON_RON6, JSON_R7, JSON_ROFF7, JSON_RON7, JSON_R8, JSON_ROFF8, JSON_RON8, JSON_ALARM, JSON_PWMD2, JSON_PWMA2, JSON_PWMD2O, JSON_PWMA2O, JSON_WL, JSON_WL1, JSON_WL2, JSON_WL3, JSON_WL4, JSON_HUM, JSON_DCM, JSON_DCS, JSON_DCD, JSON_DCT, JSON_PWME0, JSON_PWME1, JSON_PWME2, JSON_PWME3, JSON_PWME4, JSON_PWME5, JSON_PWME0O, JSON_PWME1O, JSON_PWME2O, JSON_PWME3O, JSON_PWME4O, JSON_PWME5O, JSON_AIW, JSON_AIB, JSON_AIRB, JSON_RFM, JSON_RFS, JSON_RFD, JSON_RFW, JSON_RFRB, JSON_RFR, JSON_RFG, JSON_RFB, JSON_RFI, JSON_RFWO, JSON_RFRBO, JSON_RFRO, JSON_RFGO, JSON_RFBO, JSON_RFIO, JSON_IO, JSON_LEAK, JSON_C0, JSON_C1, JSON_C2, JSON_C3, JSON_C4, JSON_C5, JSON_C6, JSON_C7, JSON_R, JSON_ROFF, JSON_RON,};
-static PROGMEM const char * const param_items_int[] = {JSON_T1, JSON_T2, JSON_T3, JSON_PH, JSON_T4, JSON_T5, JSON_T6, JSON_ORP, JSON_SAL, JSON_PHEXP, JSON_PAR, JSON_OZO, JSON_CO2, JSON_CO2HUM, JSON_CEXP0, JSON_CEXP1, JSON_CEXP2, JSON_CEXP3, JSON_CEXP4, JSON_CEXP5, JSON_CEXP6, JSON_CEXP7};
-#endif //wifi 
 
 
 class RA_Wifi: public Print
@@ -520,15 +534,21 @@ class RA_Wifi: public Print
     void WebResponse (const char* response, long strsize);
     void ModeResponse(bool fOk);
     void PushBuffer(byte inStr);
-    void PrintHeader(int s, byte type);
+    void PrintHeader(int s, byte type, boolean etag = false);
     char GetC(int c);
     void ConvertC(char* strIn, char* strOut, byte len);
     void WifiAuthentication(char* userpass);
+    void SendStatus(byte req);
     void SendXMLData(bool fAtoLog = false);
 #ifndef RA_STANDARD
     void SendJSONData();
     void SendSingleJSON(const char str[], int value, char* suffix="");
     void SendSingleJSON(const char str[], char* value);
+#ifdef REFRESH_PROFILER
+    void SendProfilerJSON();
+#endif // REFRESH_PROFILER
+    void SendBinaryData();
+    void SendSchemaJSON();
 #endif // RA_STANDARD
     void ProcessHTTP();
     void ProcessSerial();
@@ -549,11 +569,11 @@ class RA_Wifi: public Print
     
 #ifndef ETH_WIZ5100
     using Print::write;
-    inline size_t write(uint8_t c) { return _wifiSerial->write((uint8_t)c); }
-    inline size_t write(unsigned long n) { return _wifiSerial->write((uint8_t)n); }
-    inline size_t write(long n) { return _wifiSerial->write((uint8_t)n); }
-    inline size_t write(unsigned int n) { return _wifiSerial->write((uint8_t)n); }
-    inline size_t write(int n) { return _wifiSerial->write((uint8_t)n); }
+    inline size_t write(uint8_t c) { if (Buffered(c)) return 1; return _wifiSerial->write((uint8_t)c); }
+    inline size_t write(unsigned long n) { return write((uint8_t)n); }
+    inline size_t write(long n) { return write((uint8_t)n); }
+    inline size_t write(unsigned int n) { return write((uint8_t)n); }
+    inline size_t write(int n) { return write((uint8_t)n); }
 #endif // ETH_WIZ5100
 
   protected:
@@ -571,6 +591,43 @@ class RA_Wifi: public Print
     //static byte bHasComma;
     byte bCommaCount;
     boolean webnegoption;
+    char m_lastchar;
+    byte routelo;
+    byte routehi;
+    boolean measuring;
+    unsigned int measured;
+    boolean buffering;
+    boolean keepalive;
+#ifdef ETH_WIZ5100
+    boolean eventstream;
+    // false when holding this connection for /events would leave no socket free
+    virtual boolean SpareSocket() { return true; }
+#endif  // ETH_WIZ5100
+    unsigned long etag;
+    unsigned long ifnonematch;
+    byte etagstate;
+    byte etagmatch;
+    void PrintETag();
+    void ParseHeader(char c);
+    static boolean MatchHTTP(const char *pattern, byte &index, char c);
+    byte outlength;
+    uint8_t outbuffer[WIFI_OUTPUT_BUFFER];
+    virtual void FlushOutput();
+    // true when c was only counted for the Content-Length or went into the output buffer
+    inline boolean Buffered(uint8_t c)
+    {
+      if (measuring)
+      {
+        // FNV-1a hash of the body, sent as the ETag
+        measured++;
+        etag=(etag^c)*16777619UL;
+        return true;
+      }
+      if (!buffering) return false;
+      outbuffer[outlength++]=c;
+      if (outlength==sizeof(outbuffer)) FlushOutput();
+      return true;
+    }
 
   private:
 #if defined(__SAM3X8E__)
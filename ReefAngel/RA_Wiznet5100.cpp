@@ -11,10 +11,14 @@
 #include <ReefAngel.h>
 #include "RA_Wiznet5100.h"
 #include <Ethernet.h>
+#include <utility/socket.h>
 #include <EthernetDHCP.h>
 #include <RA_Wifi.h>
 #include <avr/wdt.h>
 
+// Filter for commands sent as <user>/in/<command>, the route table keeps a pointer to it
+static char RouteTopic[sizeof(CLOUD_USERNAME) + 6];
+
 RA_Wiznet5100::RA_Wiznet5100()
 {
     PortalTimeOut   = millis();
@@ -38,6 +42,12 @@ void RA_Wiznet5100::Init()
     // Start Ethernet with DHCP
     EthernetDHCP.begin(NetMac, 1); 
     NetServer.begin();
+    if (RouteTopic[0] == 0)
+    {
+        // <user>/in itself still carries "command:value" for MQTTSubCallback
+        sprintf(RouteTopic, "%s/in/+", CLOUD_USERNAME);
+        MQTTClient.route(RouteTopic, MQTTTopicCallback);
+    }
     FoundIP             = false;
     PortalConnection    = false;
     PortalWaiting       = false;
@@ -48,15 +58,21 @@ void RA_Wiznet5100::Init()
     MQTTReconnectmillis = millis();
     MQTTSendmillis      = millis();
     downloadsize        = 0;
-    sd_index            = 0;
+    resumesize          = 0;
+    firmwareretries     = 0;
+    ResetPortalHeader();
     goodheader          = false;
 
     lastActivityMillis  = millis();
+    KeepAliveMillis     = millis();
+    EventsMillis        = millis();
+    EventsSentMillis    = millis();
 }
 
 // Update()
 //  - Called repeatedly in main loop
-//  - Polls DHCP, checks IP, partial-reads portal data, etc.
+//  - Polls DHCP, checks IP, then gives each socket one budget-limited turn:
+//    HTTP request, /events stream, portal/firmware download
 void RA_Wiznet5100::Update()
 {
     EthernetDHCP.poll();
@@ -71,6 +87,7 @@ void RA_Wiznet5100::Update()
         FoundIP = true;
         // Handle normal server data
         ReceiveData();
+        SendEvents();
         // If we have portal data to read
         if (PortalClient.available() && (PortalConnection || FirmwareConnection))
         {
@@ -81,45 +98,159 @@ void RA_Wiznet5100::Update()
         checkPortalFirmwareStatus();
     }
 }
+// CRC32 (IEEE 802.3, reflected), four bits at a time
+static const unsigned long CRC32Table[16] PROGMEM = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+static unsigned long CRC32Update(unsigned long crc, const byte *data, unsigned int len)
+{
+    while (len--)
+    {
+        crc ^= *data++;
+        crc = pgm_read_dword(&CRC32Table[crc & 0x0f]) ^ (crc >> 4);
+        crc = pgm_read_dword(&CRC32Table[crc & 0x0f]) ^ (crc >> 4);
+    }
+    return crc;
+}
+
+// Portal response headers, matched with RA_Wifi::MatchHTTP
+const char PORTAL_STATUS_OK[] PROGMEM = " 200 ok";
+const char PORTAL_STATUS_PARTIAL[] PROGMEM = " 206 partial";
+const char PORTAL_CONTENT_LENGTH[] PROGMEM = "\r\ncontent-length:";
+const char PORTAL_CONTENT_RANGE[] PROGMEM = "\r\ncontent-range: bytes ";
+
+void RA_Wiznet5100::ResetPortalHeader()
+{
+    statusmatch = 0;
+    partialmatch = 0;
+    lengthmatch = 0;
+    headerendmatch = 0;
+    rangematch = 0;
+    readinglength = false;
+    readingrange = false;
+    partialresponse = false;
+    rangestart = 0;
+    sd_index = 0;
+    sd_chunks = 0;
+}
+
+// FlushFirmware()
+//  - Writes the buffered payload to FIRMWARE.BIN and folds it into the CRC
+void RA_Wiznet5100::FlushFirmware()
+{
+    if (sd_index == 0) return;
+    firmwarecrc = CRC32Update(firmwarecrc, sd_buffer, sd_index);
+    if (goodheader && firwareFile) firwareFile.write(sd_buffer, sd_index);
+    sd_index = 0;
+}
+
+// VerifyFirmware()
+//  - Reads FIRMWARE.BIN back and checks it against the size and CRC32 taken while downloading,
+//    so a bad SD write is caught before the bootloader flashes it or a download resumes on it
+//  - The first resumesize bytes were already read back when the download was resumed,
+//    their CRC32 is kept in resumecrc and only what came after them is read again
+boolean RA_Wiznet5100::VerifyFirmware(unsigned long size, unsigned long crc)
+{
+    // Both sides are the running (un-inverted) CRC32 state, only the log line shows the final value
+    File f = SD.open("FIRMWARE.BIN", FILE_READ);
+    if (!f) return false;
+    unsigned long filecrc = resumesize ? resumecrc : 0xFFFFFFFF;
+    unsigned long filesize = resumesize;
+    if (!f.seek(filesize))
+    {
+        f.close();
+        return false;
+    }
+    int len;
+    while ((len = f.read(sd_buffer, sizeof(sd_buffer))) > 0)
+    {
+        filecrc = CRC32Update(filecrc, sd_buffer, len);
+        filesize += len;
+        wdt_reset();
+    }
+    f.close();
+    Serial.print(F("CRC: "));
+    Serial.println(~filecrc, HEX);
+    return (filesize == size) && (filecrc == crc);
+}
+
+// ResumeFirmware()
+//  - Keeps the part of an interrupted download that made it to SD intact
+//    and reconnects asking only for the rest with a Range request
+boolean RA_Wiznet5100::ResumeFirmware()
+{
+    if (!goodheader || downloadsize == 0 || downloadsize >= lheader) return false;
+    if (firmwareretries >= FIRMWARE_RETRIES) return false;
+    if (!VerifyFirmware(downloadsize, firmwarecrc)) return false;
+    firmwareretries++;
+    resumesize = downloadsize;
+    resumecrc = firmwarecrc;
+    Serial.print(F("Resuming at "));
+    Serial.println(resumesize);
+    PortalConnection = false;
+    PortalDataReceived = false;
+    PortalWaiting = false;
+    FirmwareWaiting = false;
+    payload_ready = false;
+    goodheader = false;
+    FirmwareConnection = true;
+    FirmwareConnect();
+    return true;
+}
+
+// RestartFirmware()
+//  - Throws away the partial file and reconnects for the whole image without Range
+void RA_Wiznet5100::RestartFirmware()
+{
+    PortalClient.stop();
+    if (firwareFile) firwareFile.close();
+    resumesize = 0;
+    resumecrc = 0xFFFFFFFF;
+    downloadsize = 0;
+    firmwarecrc = 0xFFFFFFFF;
+    PortalConnection = false;
+    PortalDataReceived = false;
+    PortalWaiting = false;
+    FirmwareWaiting = false;
+    payload_ready = false;
+    goodheader = false;
+    FirmwareConnection = true;
+    FirmwareConnect();
+}
+
 // partialReadPortalClient()
-//  - Only read PortalClient data for up to 2s
-//    so we don't block everything else
+//  - Only read up to PORTAL_BUDGET bytes of PortalClient data per call
+//    so we don't block everything else, the rest waits for the next pass
+//  - Firmware payload is read in bulk into sd_buffer and written 32 bytes at a time
 void RA_Wiznet5100::partialReadPortalClient()
 {
-    unsigned long readStart = millis();
+    int budget = PORTAL_BUDGET;
 
-    static String headerline = "";
-    bool newline = false;
-
-    while (PortalClient.available())
+    while (budget > 0 && PortalClient.available())
     { 
-        // If we've been reading more than 2 seconds, break
-        if (millis() - readStart > READ_LOOP_MAX_MS)
-        {
-            //Serial.println(F("Breaking from PortalClient read to avoid blocking too long."));
-            break;
-        }
         // We have data => system is "active"
         lastActivityMillis = millis();
-         wdt_reset();
+        wdt_reset();
 
         // If we already saw the HTTP headers, we are reading firmware payload
         if (payload_ready)
         {
-            if (PortalClient.available() > 32)
+            int len = sizeof(sd_buffer) - sd_index;
+            if (len > budget) len = budget;
+            len = PortalClient.read(sd_buffer + sd_index, len);
+            if (len <= 0) break;
+            sd_index += len;
+            downloadsize += len;
+            budget -= len;
+            if (sd_index == sizeof(sd_buffer))
             {
-                // read 32 bytes in a burst
-                for (int i = 0; i < 32; i++)
-                {
-                    sd_buffer[i] = PortalClient.read();
-                }
-                if (goodheader) firwareFile.write(sd_buffer, 32);
-                downloadsize += 32;
-                sd_index++;
+                FlushFirmware();
                 // UI feedback
-                if (sd_index == 32)
+                if (++sd_chunks == 32)
                 {
-                    sd_index = 0;
+                    sd_chunks = 0;
                     ReefAngel.Timer[PORTAL_TIMER].Start();
                     PortalTimeOut = millis();
                     ReefAngel.Font.DrawTextP(38, 9, DOWNLOADING);
@@ -127,63 +258,74 @@ void RA_Wiznet5100::partialReadPortalClient()
                     ReefAngel.Font.DrawText("%");
                 }
             }
-            else
-            {
-                // read less than 32 bytes
-                char c = PortalClient.read();
-                downloadsize++;
-                if (goodheader) firwareFile.write(c);
-            }
         }
         else
         {
             // We are still reading headers
             char c = PortalClient.read();
+            budget--;
             downloadsize++;
-            headerline += c;
             Serial.write(c);
 
-            if (c == '\n')
+            if (readinglength)
             {
-                if (headerline.indexOf("200 OK") >= 0)
-                    goodheader = true;
-
-                byte sheader = headerline.indexOf("Length");
-                if (sheader == 8)
+                if (c >= '0' && c <= '9') lheader = lheader * 10 + c - '0';
+                else if (c != ' ') readinglength = false;
+            }
+            if (readingrange)
+            {
+                if (c >= '0' && c <= '9') rangestart = rangestart * 10 + c - '0';
+                else readingrange = false;
+            }
+            if (MatchHTTP(PORTAL_STATUS_OK, statusmatch, c))
+            {
+                // Server ignored the Range request, the whole image follows
+                goodheader = true;
+                if (resumesize && firwareFile)
                 {
-                    lheader = headerline.substring(sheader + 8).toInt();
+                    firwareFile.close();
+                    firwareFile = SD.open("FIRMWARE.BIN", O_WRITE | O_CREAT | O_TRUNC);
                 }
-                headerline = "";
-                newline = true;
-
-                // Peek next char(s)
-                if (PortalClient.available() > 0)
+                resumesize = 0;
+            }
+            if (MatchHTTP(PORTAL_STATUS_PARTIAL, partialmatch, c))
+            {
+                goodheader = true;
+                partialresponse = true;
+            }
+            if (MatchHTTP(PORTAL_CONTENT_RANGE, rangematch, c))
+            {
+                rangestart = 0;
+                readingrange = true;
+            }
+            if (MatchHTTP(PORTAL_CONTENT_LENGTH, lengthmatch, c))
+            {
+                lheader = 0;
+                readinglength = true;
+            }
+            if (MatchHTTP(HTTP_END, headerendmatch, c))
+            {
+                // A 206 that doesn't start where the SD file ends can't be appended,
+                // drop the partial file and fetch the whole image instead
+                if (FirmwareConnection && partialresponse && rangestart != resumesize)
                 {
-                    c = PortalClient.read();
-                    headerline += c;
-                    Serial.write(c);
-
-                    if (c == '\r' && newline)
-                    {
-                        // Possibly read next char if it exists
-                        if (PortalClient.available() > 0)
-                        {
-                            c = PortalClient.read();
-                            Serial.write(c);
-                        }
-
-                        if (FirmwareConnection)
-                        {
-                            payload_ready = true;
-                            if (lheader > 0) downloading = true;
-                        }
-                        downloadsize = 0;
-                    }
-                    else
+                    Serial.println(F("Range mismatch"));
+                    RestartFirmware();
+                    return;
+                }
+                // A 206 carries only the missing bytes, they follow what is on SD
+                if (FirmwareConnection)
+                {
+                    payload_ready = true;
+                    if (lheader > 0)
                     {
-                        newline = false;
+                        lheader += resumesize;
+                        downloading = true;
                     }
                 }
+                downloadsize = resumesize;
+                sd_index = 0;
+                firmwarecrc = resumesize ? resumecrc : 0xFFFFFFFF;
             }
         }
     }
@@ -207,6 +349,8 @@ void RA_Wiznet5100::checkPortalFirmwareStatus()
         }
         PortalDataReceived = false;
         FirmwareConnection = true;
+        resumesize = 0;
+        firmwareretries = 0;
         PortalWaiting = false;
         FirmwareWaiting = false;
         downloadsize = 0;
@@ -229,13 +373,13 @@ void RA_Wiznet5100::checkPortalFirmwareStatus()
         PortalWaiting = false;
         FirmwareWaiting = false;
         PortalClient.stop();
+        if (payload_ready) FlushFirmware();
         payload_ready = false;
         if (firwareFile) firwareFile.close();
 
-        // Check if full firmware downloaded
-        if ((lheader == downloadsize) && (downloadsize > 600))
+        // Check if full firmware downloaded and stored intact
+        if ((lheader == downloadsize) && (downloadsize > 600) && VerifyFirmware(downloadsize, firmwarecrc))
         {
-            if (firwareFile) firwareFile.close();
             Serial.println(F("Updating..."));
             InternalMemory.write(RemoteFirmware, 0xf0);
             while (1)
@@ -243,9 +387,10 @@ void RA_Wiznet5100::checkPortalFirmwareStatus()
                 //REEBOOT
             }
         }
-        else
+        else if (!ResumeFirmware())
         {
             // remove partial file
+            resumesize = 0;
             if (SD.exists("FIRMWARE.BIN")) SD.remove("FIRMWARE.BIN");
         }
         downloadsize = 0;
@@ -256,15 +401,24 @@ void RA_Wiznet5100::checkPortalFirmwareStatus()
     {
         Serial.println(F("Portal Timeout"));
         Serial.println(downloadsize);
+        PortalClient.stop();
+        if (payload_ready)
+        {
+            // Stalled firmware download, keep what made it to SD
+            FlushFirmware();
+            payload_ready = false;
+            if (firwareFile) firwareFile.close();
+            if (ResumeFirmware()) return;
+        }
         PortalConnection = false;
         FirmwareConnection = false;
-        PortalClient.stop();
         if (!PortalDataReceived)   Init();
         PortalDataReceived = false;
         PortalWaiting = false;
         FirmwareWaiting = false;
         downloadsize = 0;
         lheader = 0;
+        resumesize = 0;
         payload_ready = false;
         if (firwareFile) firwareFile.close();
         if (SD.exists("FIRMWARE.BIN")) SD.remove("FIRMWARE.BIN");
@@ -275,7 +429,11 @@ void RA_Wiznet5100::checkPortalFirmwareStatus()
         payload_ready = false;
         lheader = 0;
         FirmwareWaiting = true;
-        firwareFile = SD.open("FIRMWARE.BIN", O_WRITE | O_CREAT | O_TRUNC);
+        // A resumed download appends to the verified partial file
+        if (resumesize)
+            firwareFile = SD.open("FIRMWARE.BIN", O_WRITE | O_APPEND);
+        else
+            firwareFile = SD.open("FIRMWARE.BIN", O_WRITE | O_CREAT | O_TRUNC);
         if (!firwareFile)
         {
             Serial.println(F("Could not create file"));
@@ -285,30 +443,51 @@ void RA_Wiznet5100::checkPortalFirmwareStatus()
         PortalClient.print(CLOUD_USERNAME);
         PortalClient.println(" HTTP/1.1");
         PortalClient.println("Host: forum.reefangel.com");
+        if (resumesize)
+        {
+            PortalClient.print("Range: bytes=");
+            PortalClient.print(resumesize);
+            PortalClient.println("-");
+        }
         PortalClient.println("Connection: close");
         PortalClient.println();
     }
     
 }
 // ReceiveData()
-//  - Check NetServer for new client, handle data
+//  - Serve the next request from NetServer
+//  - A request that is still arriving is resumed before any other socket is accepted,
+//    for at most REQUEST_TIMEOUT from its first byte
+//  - A kept-alive NetClient stays open between calls until it goes idle
 void RA_Wiznet5100::ReceiveData()
 {
     if (FoundIP)
     {
-        NetClient = NetServer.available();
-        if (NetClient)
+        // A pipelined request may already be sitting in net_buffer
+        if (bIncoming || net_index < net_length)
         {
-            while (NetClient.connected())
+            ProcessEthernet();
+            return;
+        }
+        EthernetClient client = NetServer.available();
+        if (client)
+        {
+            // A different client takes over from an idle kept-alive one
+            if (client != NetClient)
             {
-                // We're active
-                lastActivityMillis = millis();
-                wdt_reset();
-                if (NetClient.available() > 0)
-                {
-                    ProcessEthernet();
-                }
+                if (NetClient) NetClient.stop();
+                NetClient = client;
+                net_index = net_length = 0;
             }
+            // We're active
+            lastActivityMillis = millis();
+            wdt_reset();
+            ProcessEthernet();
+        }
+        else if (NetClient && (!NetClient.connected() || millis() - KeepAliveMillis > KEEPALIVE_TIMEOUT))
+        {
+            NetClient.stop();
+            net_index = net_length = 0;
         }
     }
 }
@@ -335,56 +514,146 @@ void RA_Wiznet5100::ForceCheckFirmware()
         lheader = 0;
         payload_ready = false;
         goodheader = false;
+        resumesize = 0;
+        firmwareretries = 0;
         FirmwareConnection = true;
         delay(100);
         FirmwareConnect();
 }
 // ProcessEthernet()
-//  - Reads from NetClient until done
+//  - Reads one request from NetClient, up to the blank line after its headers
+//  - Reads at most SOCKET_BUDGET bytes per call in net_buffer sized blocks,
+//    a slow client's request is resumed on the next pass instead of holding the loop
+//  - The deadline runs from the first byte and more data doesn't move it, a client
+//    that keeps trickling bytes can't hold the server past REQUEST_TIMEOUT
+//  - HTTP/1.1 connections stay open unless the client asked to close,
+//    anything after the request is left for the next call
 void RA_Wiznet5100::ProcessEthernet()
 {
-    bIncoming = true;
-    timeout = millis();
+    if (!bIncoming)
+    {
+        // Start of a new request
+        endmatch = 0;
+        closematch = 0;
+        versionmatch = 0;
+        keepalive = true;
+        bIncoming = true;
+        timeout = millis();
+    }
+    int budget = SOCKET_BUDGET;
     while (bIncoming)
     {
-        if (millis() - timeout > 100)
-        {
-            bIncoming = false;
-            NetClient.stop();
-        }
-        if (NetClient.available() > 0)
+        if (net_index == net_length)
         {
+            // Refill in bulk, read(buf, n) checks the RX size and moves the read
+            // pointer once per block instead of once per byte
+            if (budget <= 0) break;
+            int len = NetClient.read(net_buffer, budget < (int)sizeof(net_buffer) ? budget : sizeof(net_buffer));
+            if (len <= 0) break;
+            budget -= len;
+            net_index = 0;
+            net_length = len;
             // Activity
             lastActivityMillis = millis();
             wdt_reset();
-
-            PushBuffer(NetClient.read());
-            timeout = millis();
-            if (reqtype > 0 && reqtype < 128)
-            {
-                bIncoming = false;
-                while (NetClient.available())
-                {
-                    wdt_reset();
-                    NetClient.read();
-                }
-            }
         }
+        byte c = net_buffer[net_index++];
+        if (reqtype > 0 && reqtype <= REQ_UNKNOWN)
+        {
+            // Request line is classified, read the headers
+            ParseHeader(c);
+            if (MatchHTTP(HTTP_CLOSE, closematch, c)) keepalive = false;
+            if (MatchHTTP(HTTP_END, endmatch, c)) bIncoming = false;
+        }
+        else
+        {
+            PushBuffer(c);
+        }
+        if (MatchHTTP(HTTP_10, versionmatch, c)) keepalive = false;
+    }
+    if (bIncoming)
+    {
+        if (millis() - timeout <= REQUEST_TIMEOUT) return;
+        // Request didn't finish in time, answer what we have and close
+        bIncoming = false;
+        keepalive = false;
     }
     wdt_reset();
     ProcessHTTP();
 
-    NetClient.stop();
+    if (eventstream)
+    {
+        // Keep the socket as the event stream, only one subscriber at a time
+        if (EventClient) EventClient.stop();
+        EventClient = NetClient;
+        NetClient = EthernetClient(MAX_SOCK_NUM);
+        net_index = net_length = 0;
+        EventsMillis = millis();
+        EventsSentMillis = millis();
+        eventstream = false;
+    }
+    else if (keepalive)
+        KeepAliveMillis = millis();
+    else
+    {
+        NetClient.stop();
+        net_index = net_length = 0;
+    }
+    keepalive = false;
     m_pushbackindex = 0;
 }
+// SpareSocket()
+//  - The W5100 has MAX_SOCK_NUM (4) sockets. The listener and MQTT hold one each, and
+//    the portal, DHCP renewals and the next HTTP client need one between them.
+//  - /events keeps its connection for good, so it is only handed over while another
+//    socket stays free. The listener has already moved to a new socket by now.
+boolean RA_Wiznet5100::SpareSocket()
+{
+    char spare = EventClient ? 1 : 0;    // a new subscriber replaces the old one
+    for (byte s = 0; s < MAX_SOCK_NUM; s++)
+        if (socketStatus(s) == SnSR::CLOSED) spare++;
+    if (!MQTTClient.connected()) spare--;    // MQTT gets its socket back when it reconnects
+    return spare > 0;
+}
+// SendEvents()
+//  - Pushes changed parameters to the /events subscriber as
+//    data: T1:785,R:12\n\n
+void RA_Wiznet5100::SendEvents()
+{
+    if (!EventClient) return;
+    if (!EventClient.connected())
+    {
+        EventClient.stop();
+        return;
+    }
+    if (millis() - EventsMillis < EVENTS_INTERVAL) return;
+    EventsMillis = millis();
+
+    char buffer[CLOUD_FRAME_SIZE + 8];
+    strcpy_P(buffer, PSTR("data: "));
+    while (byte len = ReefAngel.ChangedParamFrame(buffer + 6, CLOUD_FRAME_SIZE, PARAM_EVENTS))
+    {
+        strcpy_P(buffer + 6 + len, PSTR("\n\n"));
+        EventClient.write((uint8_t*)buffer, len + 8);
+        EventsSentMillis = millis();
+        wdt_reset();
+    }
+    if (millis() - EventsSentMillis > EVENTS_HEARTBEAT)
+    {
+        EventClient.write((const uint8_t*)":\n\n", 3);
+        EventsSentMillis = millis();
+    }
+}
 // Portal / Firmware Connect
 void RA_Wiznet5100::PortalConnect()
 {
+    ResetPortalHeader();
     PortalClient.noblockconnect(PortalServer, 3000);
     PortalTimeOut = millis();
 }
 void RA_Wiznet5100::FirmwareConnect()
 {
+    ResetPortalHeader();
     PortalClient.noblockconnect(WebWizardServer, 3000);
     PortalTimeOut = millis();
 }
@@ -402,13 +671,14 @@ boolean RA_Wiznet5100::IsMQTTConnected()
 // Cloud Functions for Mqtt
 void RA_Wiznet5100::Cloud() {
     if (FoundIP) {
+        // Keepalives go out even while a firmware download is running
+        MQTTClient.loop();
         if (payload_ready) {
-            // Firmware payload is active, prioritize it
+            // Firmware payload is active, it gets another budget-limited read
             partialReadPortalClient();
         } else {
             // Handle MQTT normally
             Portal(CLOUD_USERNAME);
-            MQTTClient.loop();
 
             if (millis() - MQTTReconnectmillis > 5000) {
                 if (!MQTTClient.connected()) {
@@ -437,24 +707,22 @@ void RA_Wiznet5100::Cloud() {
     }
 }
 void RA_Wiznet5100::publishParams() {
-    for (byte a = 0; a < NumParamByte; a++) {
-        if (*ReefAngel.ParamArrayByte[a] != ReefAngel.OldParamArrayByte[a]) {
-            char buffer[15];
-            strcpy_P(buffer, (char*)pgm_read_word(&(param_items_byte[a])));
-            sprintf(buffer, "%s:%d", buffer, *ReefAngel.ParamArrayByte[a]);
-            CloudPublish(buffer);
-            ReefAngel.OldParamArrayByte[a] = *ReefAngel.ParamArrayByte[a];
-        }
-    }
-    for (byte a = 0; a < NumParamInt; a++) {
-        if (*ReefAngel.ParamArrayInt[a] != ReefAngel.OldParamArrayInt[a]) {
-            char buffer[15];
-            strcpy_P(buffer, (char*)pgm_read_word(&(param_items_int[a])));
-            sprintf(buffer, "%s:%d", buffer, *ReefAngel.ParamArrayInt[a]);
-            CloudPublish(buffer);
-            ReefAngel.OldParamArrayInt[a] = *ReefAngel.ParamArrayInt[a];
+    // State updates go out as QoS 1, so a broker blip replays the latest values
+    // instead of losing them. The queue keeps a pointer to the topic.
+    static char pub_topic[sizeof(CLOUD_USERNAME) + 5];
+    if (pub_topic[0] == 0) sprintf(pub_topic, "%s/out", CLOUD_USERNAME);
+    char buffer[15];
+#ifdef REFRESH_PROFILER
+    unsigned long start = micros();
+#endif  // REFRESH_PROFILER
+    while (ReefAngel.NextChangedParam(buffer)) {
+        if (!MQTTClient.queuePublish(pub_topic, buffer)) {
+            // Queue is full, the value stays pending until the broker catches up
+            ReefAngel.RequeueParam();
+            break;
         }
     }
+    PROFILE_SAMPLE(PROFILE_PUBLISH, start);
 }
 void RA_Wiznet5100::CloudPublish(char* message)
 {
@@ -465,9 +733,46 @@ void RA_Wiznet5100::CloudPublish(char* message)
         MQTTClient.publish(pub_buffer, message);
     }
 }
+// CloudPublishStatusRecord()
+//  - Streams the whole binary status record hex encoded as BIN0:<hex>
+//    without assembling it in the MQTT packet buffer
+void RA_Wiznet5100::CloudPublishStatusRecord()
+{
+    if (MQTTClient.connected())
+    {
+        char pub_buffer[sizeof(CLOUD_USERNAME) + 5];
+        sprintf(pub_buffer, "%s/out", CLOUD_USERNAME);
+        byte size = ReefAngel.StatusRecordSize();
+        if (!MQTTClient.beginPublish(pub_buffer, 5 + size * 2, false)) return;
+        MQTTClient.print(F("BIN0:"));
+        for (byte a = 0; a < size; a++)
+        {
+            char hex[3];
+            sprintf(hex, "%02X", ReefAngel.StatusRecordByte(a));
+            MQTTClient.write((uint8_t*)hex, 2);
+        }
+        MQTTClient.endPublish();
+    }
+}
 // Write Overloads
+void RA_Wiznet5100::FlushOutput()
+{
+    if (outlength)
+    {
+        if (PortalConnection)
+        {
+            if (PortalClient.connected()) PortalClient.write(outbuffer, outlength);
+        }
+        else if (NetClient.connected())
+        {
+            NetClient.write(outbuffer, outlength);
+        }
+    }
+    outlength = 0;
+}
 size_t RA_Wiznet5100::write(uint8_t c)
 {
+    if (Buffered(c)) return 1;
     if (PortalConnection)
     {
         if (PortalClient.connected())
@@ -25,13 +25,20 @@ static byte NetMac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
 static IPAddress NetIP(192, 168, 1, 200);
 
 static EthernetClient NetClient;    // General-purpose client
+static EthernetClient EventClient;  // Client subscribed to /events
 static EthernetClient PortalClient; // Client for portal operations
 static EthernetClient ethClient;    // Client for MQTT communication
 static PubSubClient  MQTTClient(MQTTServer, MQTTPORT, MQTTSubCallback, ethClient);
 
 // Flags and timeout settings
 #define PORTAL_TIMEOUT   10000    // 10 seconds
-#define READ_LOOP_MAX_MS 5000UL
+#define SOCKET_BUDGET    128      // bytes an HTTP client may move per pass before the other sockets get a turn
+#define PORTAL_BUDGET    512      // bytes of portal/firmware data read per pass
+#define REQUEST_TIMEOUT  500      // a request still arriving this long after its first byte is answered with what has arrived
+#define FIRMWARE_RETRIES 5        // an interrupted download is resumed this many times
+#define KEEPALIVE_TIMEOUT 2000    // idle persistent connections are closed after 2 seconds
+#define EVENTS_INTERVAL   250     // changed parameters are pushed to /events this often
+#define EVENTS_HEARTBEAT  15000   // an idle /events stream gets a comment line this often
 
 static boolean PortalWaiting;
 static boolean FirmwareWaiting;
@@ -46,6 +53,7 @@ public:
     // Handling incoming data
     void ReceiveData();         // Handle incoming data from NetServer
     void ProcessEthernet();     // Process data from NetClient
+    void SendEvents();          // Push changed parameters to EventClient
 
     // Portal / Firmware
     void PortalConnect();       // Connect to PortalServer
@@ -54,11 +62,15 @@ public:
     void ForceCheckFirmware(); // Call to check for firmware
     void partialReadPortalClient();
     void checkPortalFirmwareStatus();
+    boolean VerifyFirmware(unsigned long size, unsigned long crc); // Read FIRMWARE.BIN back and compare its CRC32
+    boolean ResumeFirmware();   // Reconnect for the missing part of an interrupted download
+    void RestartFirmware();     // Drop the partial file and download the whole image again
 
 
     // Cloud (MQTT) operations
     void Cloud();
     void CloudPublish(char* message);
+    void CloudPublishStatusRecord(); // Stream the binary status record as one message
     boolean IsMQTTConnected();
 
     
@@ -88,14 +100,50 @@ private:
     File firwareFile;
 
     // Buffers
+    // SD coalesces these into its own 512 byte block cache, a 512 byte buffer here would
+    // only be copied into that cache and cost another 480 bytes of the 8 KB SRAM
     byte sd_buffer[32];
     byte sd_index;
+    byte sd_chunks;             // progress is redrawn every 32 chunks
+    unsigned long firmwarecrc;  // CRC32 of the payload as it arrived
+    unsigned long resumesize;   // bytes already in FIRMWARE.BIN and read back, requested with Range
+    unsigned long resumecrc;    // CRC32 of those bytes
+    byte firmwareretries;
+    void FlushFirmware();
+
+    // Portal response header matches
+    byte statusmatch;
+    byte partialmatch;
+    byte lengthmatch;
+    byte headerendmatch;
+    byte rangematch;
+    boolean readinglength;
+    boolean readingrange;
+    boolean partialresponse;    // 206, body starts at rangestart
+    unsigned long rangestart;
+    void ResetPortalHeader();
+
+    // Header matches of the request in progress on NetClient
+    byte endmatch;
+    byte closematch;
+    byte versionmatch;
+    // NetClient bytes read in bulk, what is left after a request waits for the next one
+    byte net_buffer[32];
+    byte net_index;
+    byte net_length;
 
     // Track the last time we saw "activity"
     unsigned long lastActivityMillis;
+    // Last request served on a persistent NetClient
+    unsigned long KeepAliveMillis;
+    // /events stream timers
+    unsigned long EventsMillis;
+    unsigned long EventsSentMillis;
 
 protected:
     size_t write(uint8_t c);
+    void FlushOutput();
+    boolean SpareSocket();
 };
 
 #endif  // ETH_WIZ5100
@@ -48,6 +48,58 @@ const byte ReefAngelClass::PH_DEFAULT_RANGE[2]={7, 10};
 const char ReefAngelClass::PH_SETUP_MENU_LABEL[2][19]={"Calibrate pH", "Calibrate pH(Exp.)"};
 const char ReefAngelClass::PH_SETUP_MENU_STEP[2][13]={"First value", "Second value"};
 
+// Periodic tasks run by ReefAngel.Scheduler from Refresh()
+#ifdef AI_LED
+static void AIStreamTask()
+{
+	ReefAngel.AI.Send();
+	ReefAngel.Scheduler.SetInterval(ReefAngel.AITaskID,ReefAngel.AI.StreamDelay);
+}
+#endif  // AI_LED
+#ifdef RANET
+static void RANetTask()
+{
+	ReefAngel.RANetSend();
+}
+#endif  // RANET
+#ifdef CLOUD_WIFI
+static void CloudTask()
+{
+	ReefAngel.CloudPush();
+}
+#endif  // CLOUD_WIFI
+#ifdef I2CMASTER
+static void MasterTask()
+{
+	ReefAngel.MasterUpdate();
+}
+#endif  // I2CMASTER
+#if defined SALINITYEXPANSION || defined ORPEXPANSION || defined PHEXPANSION
+// While the cloud overrides a sensor its ring is emptied, so old readings don't
+// mix into the first average after the override ends
+static void SampleTask()
+{
+#if defined SALINITYEXPANSION
+	if (bitRead(ReefAngel.CEM,CloudSalinityBit))
+		ReefAngel.SalinitySamples.Clear();
+	else
+		ReefAngel.SalinitySamples.Add(ReefAngel.Salinity.Read());
+#endif  // defined SALINITYEXPANSION
+#if defined ORPEXPANSION
+	if (bitRead(ReefAngel.CEM,CloudORPBit))
+		ReefAngel.ORPSamples.Clear();
+	else
+		ReefAngel.ORPSamples.Add(ReefAngel.ORP.Read());
+#endif  // defined ORPEXPANSION
+#if defined PHEXPANSION
+	if (bitRead(ReefAngel.CEM,CloudPHExpBit))
+		ReefAngel.PHExpSamples.Clear();
+	else
+		ReefAngel.PHExpSamples.Add(ReefAngel.PH.Read());
+#endif  // defined PHEXPANSION
+}
+#endif  // SALINITYEXPANSION || ORPEXPANSION || PHEXPANSION
+
 
 void ReefAngelClass::Init()
 {
@@ -197,11 +249,21 @@ void ReefAngelClass::Init()
 		CustomVar[EID]=0;
 	}
 #endif //CUSTOM_VARIABLES
+#ifdef AI_LED
+	AITaskID=Scheduler.Add(AIStreamTask,AI.StreamDelay);
+#endif  // AI_LED
+#ifdef RANET
+	Scheduler.Add(RANetTask,RANetDelay);
+#endif  // RANET
 #ifdef CLOUD_WIFI
-	CloudDummyByte=0;
-	CloudDummyInt=0;
-	LastCloudCheck=millis();
-#endif
+	Scheduler.Add(CloudTask,1000);
+#endif  // CLOUD_WIFI
+#ifdef I2CMASTER
+	Scheduler.Add(MasterTask,1000);
+#endif  // I2CMASTER
+#if defined SALINITYEXPANSION || defined ORPEXPANSION || defined PHEXPANSION
+	Scheduler.Add(SampleTask,SAMPLE_PERIOD);
+#endif  // SALINITYEXPANSION || ORPEXPANSION || PHEXPANSION
 #ifdef RA_TOUCHDISPLAY
 	SendMaster(MESSAGE_RESEND_ALL,0,0);
 #endif // RA_TOUCHDISPLAY
@@ -210,6 +272,7 @@ void ReefAngelClass::Init()
 void ReefAngelClass::Refresh()
 {
 	WDTReset();
+	PROFILE_START();
 	switch (ChangeMode)
 	{
 	case FEEDING_MODE:
@@ -383,6 +446,7 @@ void ReefAngelClass::Refresh()
 	}
 	SetDCPumpChannels(SyncSpeed,AntiSyncSpeed);
 #endif  // DCPUMPCONTROL
+	PROFILE_MARK(PROFILE_DCPUMP);
 
 #if defined DisplayLEDPWM && !defined REEFANGEL_MINI
 #ifndef DCPUMPCONTROL
@@ -434,6 +498,7 @@ void ReefAngelClass::Refresh()
 	analogWrite(daylight2PWMPin, map(VariableControl.GetDaylight2ValueRaw(),0,4095,0,255));
 #endif  // __SAM3X8E__
 #endif  // defined DisplayLEDPWM && !defined REEFANGEL_MINI
+	PROFILE_MARK(PROFILE_PWM);
 
 
 #if defined RA_TOUCH || defined RA_TOUCHDISPLAY || defined RA_EVOLUTION || defined RA_STAR
@@ -457,6 +522,7 @@ void ReefAngelClass::Refresh()
 		TouchLCD.FullClear(BKCOLOR);
 	}
 #endif //  RA_TOUCH
+	PROFILE_MARK(PROFILE_TOUCH);
 
 #if not defined RA_TOUCHDISPLAY
 #ifdef RFEXPANSION
@@ -487,12 +553,8 @@ void ReefAngelClass::Refresh()
 		for (byte a=0; a<AI_CHANNELS; a++)
 			AI.SetChannel(a,InternalMemory.read(Mem_B_AISlopeEndW+(3*a)));
 	}
-	if (millis()-AI.AImillis>AI.StreamDelay)
-	{
-		AI.Send();
-		AI.AImillis=millis();
-	}
 #endif  // AI_LED
+	PROFILE_MARK(PROFILE_RFAI);
 
 #if defined PWMEXPANSION && defined DisplayLEDPWM
 #if defined(__SAM3X8E__)
@@ -515,6 +577,7 @@ void ReefAngelClass::Refresh()
 		IO.GetChannel();
 #endif  // IOEXPANSION
 #endif  // RA_TOUCHDISPLAY
+	PROFILE_MARK(PROFILE_EXPANSION);
 
 #ifdef OVERRIDE_PORTS
 	// Reset relay masks for ports we want always in their programmed states.
@@ -539,192 +602,63 @@ void ReefAngelClass::Refresh()
 	}
 #endif // RA_PLUS
 	Relay.Write();
+	PROFILE_MARK(PROFILE_RELAY);
 
 #ifdef ETH_WIZ5100
 	Network.Update();
 #endif // ETH_WIZ5100
+	PROFILE_MARK(PROFILE_NETWORK);
 
-#ifdef RANET
-	// Send RANet data
-	if (millis()-RANetlastmillis>RANetDelay)
-	{
-		RANetlastmillis=millis();
-		RANetCRC=0;
-		RANetData[0]=RANetSeq;
-		RANetData[1]=RANET_SIZE;
-		for (int a=0;a<MAX_RELAY_EXPANSION_MODULES;a++)
-		{
-#ifdef RelayExp
-			byte TempRelay = Relay.RelayDataE[a];
-			TempRelay &= Relay.RelayMaskOffE[a];
-			TempRelay |= Relay.RelayMaskOnE[a];
-			RANetData[2+a]=TempRelay;
-			RANetData[10+a]=Relay.RANetFallBackE[a];
-#else
-			RANetData[2+a]=0;
-			RANetData[10+a]=0;
-#endif // RelayExp
-		}
-		for (int a=0;a<PWM_EXPANSION_CHANNELS*2;a=a+2)
-		{
-#ifdef PWMEXPANSION
-#if defined(__SAM3X8E__)
-			RANetData[18+a]=VariableControl.GetChannelValue(a);
-#else
-			int newdata=PWM.GetChannelValueRaw(a/2);
-			RANetData[18+a]=newdata&0xff;	// LSB
-			RANetData[18+a+1]=newdata>>8;	// MSB
-
-#endif
-#else
-			RANetData[18+a]=0;
-			RANetData[18+a+1]=0;
-#endif // PWMEXPANSION
-		}
-		for (int a=0;a<SIXTEENCH_PWM_EXPANSION_CHANNELS*2;a=a+2)
-		{
-#ifdef SIXTEENCHPWMEXPANSION
-#if defined(__SAM3X8E__)
-			RANetData[26+a]=VariableControl.Get16ChannelValue(a);
-#else
-			int newdata=PWM.Get16ChannelValueRaw(a/2);
-			RANetData[30+a]=newdata&0xff;	// LSB
-			RANetData[30+a+1]=newdata>>8;	// MSB
-#endif
-#else
-			RANetData[30+a]=0;
-			RANetData[30+a+1]=0;
-#endif // SIXTEENCHPWMEXPANSION
-		}
-//		char buf[3];
-		RANetData[62]=TriggerValue;	// Trigger byte
-		TriggerValue=0;				// Reset to 0
-		for (int a=0;a<RANET_SIZE-2;a++)
-		{
-			RANetCRC+=RANetData[a];
-			RANET_SERIAL.write(RANetData[a]);
-			delay(1);
-//			Serial.print(RANetData[a]);
-//			Serial.print(",");
-//			sprintf(buf,"%02x",RANetData[a]);
-//			RANET_SERIAL.print(buf);
-		}
-		RANET_SERIAL.write(RANetCRC);
-		RANET_SERIAL.println();
-//		Serial.print(RANetCRC);
-//		Serial.println();
-		delay(1);
-//		sprintf(buf,"%02x",RANetCRC);
-//		RANET_SERIAL.println(buf);
-		RANetSeq++;
-	}
-#endif // RANET
+	Scheduler.Run();
+	PROFILE_MARK(PROFILE_SCHEDULER);
 #if defined wifi || defined RA_STAR
     ReefAngel.Network.ReceiveData();
 #endif  // wifi || defined RA_STAR
+	PROFILE_MARK(PROFILE_RECEIVE);
+
+	// Sensors are oversampled and filtered once the probe cycle below completes.
+	// The onboard pH is read every pass, the I2C expansions by SampleTask every SAMPLE_PERIOD.
+	PHSamples.Add(analogRead(PHPin));
+	PROFILE_MARK(PROFILE_ANALOG);
 
-	if (ds.read_bit()==0) return;  // ds for OneWire TempSensor
 	now();
+	// One probe is read per pass, the rest of the sensors are refreshed once every probe has been read
+	byte probe=TempSensor.Update();
+	if (probe!=TEMP_NONE)
+	{
 #ifdef DirectTempSensor
-	RefreshScreen();
-	Params.Temp[T1_PROBE]=TempSensor.ReadTemperature(TempSensor.addrT1);
-	RefreshScreen();
-	Params.Temp[T2_PROBE]=TempSensor.ReadTemperature(TempSensor.addrT2);
-	RefreshScreen();
-	Params.Temp[T3_PROBE]=TempSensor.ReadTemperature(TempSensor.addrT3);
-	RefreshScreen();
-#ifdef EXTRA_TEMP_PROBES
-	Params.Temp[T4_PROBE]=TempSensor.ReadTemperature(TempSensor.addrT4);
-	RefreshScreen();
-	Params.Temp[T5_PROBE]=TempSensor.ReadTemperature(TempSensor.addrT5);
-	RefreshScreen();
-	Params.Temp[T6_PROBE]=TempSensor.ReadTemperature(TempSensor.addrT6);
-	RefreshScreen();
-#endif // EXTRA_TEMP_PROBES
+		Params.Temp[T1_PROBE+probe]=TempSensor.Value;
 #else  // DirectTempSensor
-	int x=0;
-	int y=0;
-	if (TempSensor.addrT1[0]!=0 && TempSensor.addrT1[7]!=0)
-	{
-		x = TempSensor.ReadTemperature(TempSensor.addrT1);
-		RefreshScreen();
-		y = x - Params.Temp[T1_PROBE];
+		int x=TempSensor.Value;
+		int y=x-Params.Temp[T1_PROBE+probe];
 		// check to make sure the temp readings aren't beyond max allowed
-		if ( abs(y) < MAX_TEMP_SWING || Params.Temp[T1_PROBE] == 0 || ~x) Params.Temp[T1_PROBE] = x;
-	}
-	if (TempSensor.addrT2[0]!=0 && TempSensor.addrT2[7]!=0)
-	{
-		x = TempSensor.ReadTemperature(TempSensor.addrT2);
-		RefreshScreen();
-		y = x - Params.Temp[T2_PROBE];
-		if ( abs(y) < MAX_TEMP_SWING || Params.Temp[T2_PROBE] == 0 || ~x) Params.Temp[T2_PROBE] = x;
-	}
-	if (TempSensor.addrT3[0]!=0 && TempSensor.addrT3[7]!=0)
-	{
-		x = TempSensor.ReadTemperature(TempSensor.addrT3);
-		RefreshScreen();
-		y = x - Params.Temp[T3_PROBE];
-		if ( abs(y) < MAX_TEMP_SWING || Params.Temp[T3_PROBE] == 0 || ~x) Params.Temp[T3_PROBE] = x;
-	}
-#ifdef EXTRA_TEMP_PROBES
-	if (TempSensor.addrT4[0]!=0 && TempSensor.addrT4[7]!=0)
-	{
-		x = TempSensor.ReadTemperature(TempSensor.addrT4);
-		RefreshScreen();
-		y = x - Params.Temp[T4_PROBE];
-		if ( abs(y) < MAX_TEMP_SWING || Params.Temp[T4_PROBE] == 0 || ~x) Params.Temp[T4_PROBE] = x;
-	}
-	if (TempSensor.addrT5[0]!=0 && TempSensor.addrT5[7]!=0)
-	{
-		x = TempSensor.ReadTemperature(TempSensor.addrT5);
-		RefreshScreen();
-		y = x - Params.Temp[T5_PROBE];
-		if ( abs(y) < MAX_TEMP_SWING || Params.Temp[T5_PROBE] == 0 || ~x) Params.Temp[T5_PROBE] = x;
-	}
-	if (TempSensor.addrT6[0]!=0 && TempSensor.addrT6[7]!=0)
-	{
-		x = TempSensor.ReadTemperature(TempSensor.addrT6);
+		if ( abs(y) < MAX_TEMP_SWING || Params.Temp[T1_PROBE+probe] == 0 || ~x) Params.Temp[T1_PROBE+probe] = x;
+#endif  // DirectTempSensor
 		RefreshScreen();
-		y = x - Params.Temp[T6_PROBE];
-		if ( abs(y) < MAX_TEMP_SWING || Params.Temp[T6_PROBE] == 0 || ~x) Params.Temp[T6_PROBE] = x;
 	}
-#endif // EXTRA_TEMP_PROBES
-#endif  // DirectTempSensor
-	Params.PH=0;
-	for (int a=0;a<20;a++)
+	PROFILE_MARK(PROFILE_TEMP);
+	if (!TempSensor.IsCycleDone())
 	{
-		Params.PH+=analogRead(PHPin);
+		PROFILE_END();
+		return;
 	}
-	Params.PH/=20;
-	RefreshScreen();
+	Params.PH=PHSamples.Get();
 	Params.PH=map(Params.PH, PHMin, PHMax, 700, 1000); // apply the calibration to the sensor reading
 	Params.PH=constrain(Params.PH,100,1400);
 	RefreshScreen();
-	TempSensor.RequestConversion();
-	RefreshScreen();
 #if defined SALINITYEXPANSION
-	if (bitRead(ReefAngel.CEM,CloudSalinityBit)==0)
+	if (bitRead(ReefAngel.CEM,CloudSalinityBit)==0 && SalinitySamples.GetCount())
 	{
-		unsigned long tempsal=0;
-		for (int a=0;a<20;a++)
-		{
-			tempsal+=Salinity.Read();
-		}
-		Params.Salinity=tempsal/20;
+		Params.Salinity=SalinitySamples.Get();
 		ApplySalinityCompensation();
 		Params.Salinity=map(Params.Salinity, 0, SalMax, 60, 350); // apply the calibration to the sensor reading
 	}
 	RefreshScreen();
 #endif  // defined SALINITYEXPANSION
 #if defined ORPEXPANSION
-	if (bitRead(ReefAngel.CEM,CloudORPBit)==0)
+	if (bitRead(ReefAngel.CEM,CloudORPBit)==0 && ORPSamples.GetCount())
 	{
-		unsigned long temporp=0;
-		for (int a=0;a<20;a++)
-		{
-			temporp+=ORP.Read();
-		}
-		Params.ORP=temporp/20;
+		Params.ORP=ORPSamples.Get();
 		if (Params.ORP!=0)
 		{
 			Params.ORP=map(Params.ORP, ORPMin, ORPMax, 0, 470); // apply the calibration to the sensor reading
@@ -734,14 +668,9 @@ void ReefAngelClass::Refresh()
 	RefreshScreen();
 #endif  // defined ORPEXPANSION
 #if defined PHEXPANSION
-	if (bitRead(ReefAngel.CEM,CloudPHExpBit)==0)
+	if (bitRead(ReefAngel.CEM,CloudPHExpBit)==0 && PHExpSamples.GetCount())
 	{
-		unsigned long tempph=0;
-		for (int a=0;a<5;a++)
-		{
-			tempph+=PH.Read();
-		}
-		Params.PHExp=tempph/5;
+		Params.PHExp=PHExpSamples.Get();
 		if (Params.PHExp!=0)
 		{
 			Params.PHExp=map(Params.PHExp, PHExpMin, PHExpMax, 700, 1000); // apply the calibration to the sensor reading
@@ -794,6 +723,7 @@ void ReefAngelClass::Refresh()
 			wdt_reset();
 		}
 		cbi(PORTH,2); // Turn on exp bus power
+		Relay.Refresh();  // relay boxes lost their state with the power cycle
 
 		int rtn = I2C_ClearBus(); // clear the I2C bus first before calling Wire.begin()
 		  if (rtn != 0) {
@@ -843,6 +773,8 @@ if (bitRead(ReefAngel.CEM1, CloudCo2Bit) == 0) {
 }    
 
 #endif  // CO2EXPANSION
+	PROFILE_MARK(PROFILE_SENSORS);
+	PROFILE_END();
 }
 
 void ReefAngelClass::Reboot()
@@ -858,6 +790,78 @@ void ReefAngelClass::RANetTrigger(byte Trigger)
 {
 	TriggerValue = Trigger;
 }
+
+void ReefAngelClass::RANetSend()
+{
+	RANetCRC=0;
+	RANetData[0]=RANetSeq;
+	RANetData[1]=RANET_SIZE;
+	for (int a=0;a<MAX_RELAY_EXPANSION_MODULES;a++)
+	{
+#ifdef RelayExp
+		byte TempRelay = Relay.RelayDataE[a];
+		TempRelay &= Relay.RelayMaskOffE[a];
+		TempRelay |= Relay.RelayMaskOnE[a];
+		RANetData[2+a]=TempRelay;
+		RANetData[10+a]=Relay.RANetFallBackE[a];
+#else
+		RANetData[2+a]=0;
+		RANetData[10+a]=0;
+#endif // RelayExp
+	}
+	for (int a=0;a<PWM_EXPANSION_CHANNELS*2;a=a+2)
+	{
+#ifdef PWMEXPANSION
+#if defined(__SAM3X8E__)
+		RANetData[18+a]=VariableControl.GetChannelValue(a);
+#else
+		int newdata=PWM.GetChannelValueRaw(a/2);
+		RANetData[18+a]=newdata&0xff;	// LSB
+		RANetData[18+a+1]=newdata>>8;	// MSB
+
+#endif
+#else
+		RANetData[18+a]=0;
+		RANetData[18+a+1]=0;
+#endif // PWMEXPANSION
+	}
+	for (int a=0;a<SIXTEENCH_PWM_EXPANSION_CHANNELS*2;a=a+2)
+	{
+#ifdef SIXTEENCHPWMEXPANSION
+#if defined(__SAM3X8E__)
+		RANetData[26+a]=VariableControl.Get16ChannelValue(a);
+#else
+		int newdata=PWM.Get16ChannelValueRaw(a/2);
+		RANetData[30+a]=newdata&0xff;	// LSB
+		RANetData[30+a+1]=newdata>>8;	// MSB
+#endif
+#else
+		RANetData[30+a]=0;
+		RANetData[30+a+1]=0;
+#endif // SIXTEENCHPWMEXPANSION
+	}
+//	char buf[3];
+	RANetData[62]=TriggerValue;	// Trigger byte
+	TriggerValue=0;				// Reset to 0
+	for (int a=0;a<RANET_SIZE-2;a++)
+	{
+		RANetCRC+=RANetData[a];
+		RANET_SERIAL.write(RANetData[a]);
+		delay(1);
+//		Serial.print(RANetData[a]);
+//		Serial.print(",");
+//		sprintf(buf,"%02x",RANetData[a]);
+//		RANET_SERIAL.print(buf);
+	}
+	RANET_SERIAL.write(RANetCRC);
+	RANET_SERIAL.println();
+//	Serial.print(RANetCRC);
+//	Serial.println();
+	delay(1);
+//	sprintf(buf,"%02x",RANetCRC);
+//	RANET_SERIAL.println(buf);
+	RANetSeq++;
+}
 #endif // RANET
 
 void ReefAngelClass::SetTemperatureUnit(byte unit)
@@ -1959,6 +1963,230 @@ void ReefAngelClass::SetDisplayedMenu(byte value)
 #endif // RA_TOUCHDISPLAY
 }
 
+#if defined wifi || defined CLOUD_WIFI || defined ETH_WIZ5100
+// Cloud parameter registry
+// Only parameters compiled into this build are listed. Names and addresses stay in flash,
+// the last value sent to the cloud is kept in the OldParam arrays.
+typedef struct
+{
+	const char *name;
+	byte *value;
+} ParamByteEntry;
+
+typedef struct
+{
+	const char *name;
+	int *value;
+} ParamIntEntry;
+
+// Entries hold pointers, pgm_read_word would cut them to 16 bits on the Due
+#ifndef pgm_read_ptr
+#if defined(__SAM3X8E__)
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+#else
+#define pgm_read_ptr(addr) ((void *)pgm_read_word(addr))
+#endif  // __SAM3X8E__
+#endif  // pgm_read_ptr
+
+static const ParamByteEntry ParamByte[] PROGMEM = {
+	{JSON_ATOLOW,&ReefAngel.LowATO.Status}, {JSON_ATOHIGH,&ReefAngel.HighATO.Status},
+	{JSON_EM,&ReefAngel.EM}, {JSON_EM1,&ReefAngel.EM1}, {JSON_REM,&ReefAngel.REM}, {JSON_BOARDID,&ReefAngel.Board},
+	{JSON_ALERTFLAG,&ReefAngel.AlertFlags}, {JSON_STATUSFLAG,&ReefAngel.StatusFlags},
+#if defined DisplayLEDPWM && ! defined RemoveAllLights || defined DCPUMPCONTROL
+	{JSON_PWMD,&ReefAngel.PWM.DaylightPercentage}, {JSON_PWMA,&ReefAngel.PWM.ActinicPercentage},
+	{JSON_PWMDO,&ReefAngel.PWM.DaylightPWMOverride}, {JSON_PWMAO,&ReefAngel.PWM.ActinicPWMOverride},
+#endif
+#ifdef RelayExp
+	{JSON_R1,&ReefAngel.Relay.RelayDataE[0]}, {JSON_ROFF1,&ReefAngel.Relay.RelayMaskOffE[0]}, {JSON_RON1,&ReefAngel.Relay.RelayMaskOnE[0]},
+	{JSON_R2,&ReefAngel.Relay.RelayDataE[1]}, {JSON_ROFF2,&ReefAngel.Relay.RelayMaskOffE[1]}, {JSON_RON2,&ReefAngel.Relay.RelayMaskOnE[1]},
+	{JSON_R3,&ReefAngel.Relay.RelayDataE[2]}, {JSON_ROFF3,&ReefAngel.Relay.RelayMaskOffE[2]}, {JSON_RON3,&ReefAngel.Relay.RelayMaskOnE[2]},
+	{JSON_R4,&ReefAngel.Relay.RelayDataE[3]}, {JSON_ROFF4,&ReefAngel.Relay.RelayMaskOffE[3]}, {JSON_RON4,&ReefAngel.Relay.RelayMaskOnE[3]},
+	{JSON_R5,&ReefAngel.Relay.RelayDataE[4]}, {JSON_ROFF5,&ReefAngel.Relay.RelayMaskOffE[4]}, {JSON_RON5,&ReefAngel.Relay.RelayMaskOnE[4]},
+	{JSON_R6,&ReefAngel.Relay.RelayDataE[5]}, {JSON_ROFF6,&ReefAngel.Relay.RelayMaskOffE[5]}, {JSON_RON6,&ReefAngel.Relay.RelayMaskOnE[5]},
+	{JSON_R7,&ReefAngel.Relay.RelayDataE[6]}, {JSON_ROFF7,&ReefAngel.Relay.RelayMaskOffE[6]}, {JSON_RON7,&ReefAngel.Relay.RelayMaskOnE[6]},
+	{JSON_R8,&ReefAngel.Relay.RelayDataE[7]}, {JSON_ROFF8,&ReefAngel.Relay.RelayMaskOffE[7]}, {JSON_RON8,&ReefAngel.Relay.RelayMaskOnE[7]},
+#endif
+#ifdef RA_STAR
+	{JSON_ALARM,&ReefAngel.AlarmInput.Status},
+	{JSON_PWMD2,&ReefAngel.PWM.Daylight2Percentage}, {JSON_PWMA2,&ReefAngel.PWM.Actinic2Percentage},
+	{JSON_PWMD2O,&ReefAngel.PWM.Daylight2PWMOverride}, {JSON_PWMA2O,&ReefAngel.PWM.Actinic2PWMOverride},
+#endif
+#if defined WATERLEVELEXPANSION || defined MULTIWATERLEVELEXPANSION
+	{JSON_WL,&ReefAngel.WaterLevel.level[0]}, {JSON_WL1,&ReefAngel.WaterLevel.level[1]}, {JSON_WL2,&ReefAngel.WaterLevel.level[2]},
+	{JSON_WL3,&ReefAngel.WaterLevel.level[3]}, {JSON_WL4,&ReefAngel.WaterLevel.level[4]},
+#endif
+#ifdef HUMIDITYEXPANSION
+	{JSON_HUM,&ReefAngel.Humidity.level},
+#endif
+#ifdef DCPUMPCONTROL
+	{JSON_DCM,&ReefAngel.DCPump.Mode}, {JSON_DCS,&ReefAngel.DCPump.Speed}, {JSON_DCD,&ReefAngel.DCPump.Duration}, {JSON_DCT,&ReefAngel.DCPump.Threshold},
+#endif
+#ifdef PWMEXPANSION
+	{JSON_PWME0,&ReefAngel.PWM.ExpansionPercentage[0]}, {JSON_PWME1,&ReefAngel.PWM.ExpansionPercentage[1]}, {JSON_PWME2,&ReefAngel.PWM.ExpansionPercentage[2]},
+	{JSON_PWME3,&ReefAngel.PWM.ExpansionPercentage[3]}, {JSON_PWME4,&ReefAngel.PWM.ExpansionPercentage[4]}, {JSON_PWME5,&ReefAngel.PWM.ExpansionPercentage[5]},
+	{JSON_PWME0O,&ReefAngel.PWM.ExpansionChannelOverride[0]}, {JSON_PWME1O,&ReefAngel.PWM.ExpansionChannelOverride[1]}, {JSON_PWME2O,&ReefAngel.PWM.ExpansionChannelOverride[2]},
+	{JSON_PWME3O,&ReefAngel.PWM.ExpansionChannelOverride[3]}, {JSON_PWME4O,&ReefAngel.PWM.ExpansionChannelOverride[4]}, {JSON_PWME5O,&ReefAngel.PWM.ExpansionChannelOverride[5]},
+#endif
+#ifdef AI_LED
+	{JSON_AIW,&ReefAngel.AI.AIChannels[0]}, {JSON_AIB,&ReefAngel.AI.AIChannels[1]}, {JSON_AIRB,&ReefAngel.AI.AIChannels[2]},
+#endif
+#ifdef RFEXPANSION
+	{JSON_RFM,&ReefAngel.RF.Mode}, {JSON_RFS,&ReefAngel.RF.Speed}, {JSON_RFD,&ReefAngel.RF.Duration},
+	{JSON_RFW,&ReefAngel.RF.RadionChannels[0]}, {JSON_RFRB,&ReefAngel.RF.RadionChannels[1]}, {JSON_RFR,&ReefAngel.RF.RadionChannels[2]},
+	{JSON_RFG,&ReefAngel.RF.RadionChannels[3]}, {JSON_RFB,&ReefAngel.RF.RadionChannels[4]}, {JSON_RFI,&ReefAngel.RF.RadionChannels[5]},
+	{JSON_RFWO,&ReefAngel.RF.RadionChannelsOverride[0]}, {JSON_RFRBO,&ReefAngel.RF.RadionChannelsOverride[1]}, {JSON_RFRO,&ReefAngel.RF.RadionChannelsOverride[2]},
+	{JSON_RFGO,&ReefAngel.RF.RadionChannelsOverride[3]}, {JSON_RFBO,&ReefAngel.RF.RadionChannelsOverride[4]}, {JSON_RFIO,&ReefAngel.RF.RadionChannelsOverride[5]},
+#endif
+#ifdef IOEXPANSION
+	{JSON_IO,&ReefAngel.IO.IOPorts},
+#endif
+#if defined LEAKDETECTOREXPANSION || defined RA_STAR
+	{JSON_LEAK,&ReefAngel.LeakValue},
+#endif
+#ifdef CUSTOM_VARIABLES
+	{JSON_C0,&ReefAngel.CustomVar[0]}, {JSON_C1,&ReefAngel.CustomVar[1]}, {JSON_C2,&ReefAngel.CustomVar[2]}, {JSON_C3,&ReefAngel.CustomVar[3]},
+	{JSON_C4,&ReefAngel.CustomVar[4]}, {JSON_C5,&ReefAngel.CustomVar[5]}, {JSON_C6,&ReefAngel.CustomVar[6]}, {JSON_C7,&ReefAngel.CustomVar[7]},
+#endif
+	{JSON_R,&ReefAngel.Relay.RelayData}, {JSON_ROFF,&ReefAngel.Relay.RelayMaskOff}, {JSON_RON,&ReefAngel.Relay.RelayMaskOn},
+};
+
+static const ParamIntEntry ParamInt[] PROGMEM = {
+	{JSON_T1,&ReefAngel.Params.Temp[T1_PROBE]}, {JSON_T2,&ReefAngel.Params.Temp[T2_PROBE]}, {JSON_T3,&ReefAngel.Params.Temp[T3_PROBE]},
+	{JSON_PH,&ReefAngel.Params.PH},
+#ifdef EXTRA_TEMP_PROBES
+	{JSON_T4,&ReefAngel.Params.Temp[T4_PROBE]}, {JSON_T5,&ReefAngel.Params.Temp[T5_PROBE]}, {JSON_T6,&ReefAngel.Params.Temp[T6_PROBE]},
+#endif
+#ifdef ORPEXPANSION
+	{JSON_ORP,&ReefAngel.Params.ORP},
+#endif
+#ifdef SALINITYEXPANSION
+	{JSON_SAL,&ReefAngel.Params.Salinity},
+#endif
+#ifdef PHEXPANSION
+	{JSON_PHEXP,&ReefAngel.Params.PHExp},
+#endif
+#ifdef PAREXPANSION
+	{JSON_PAR,&ReefAngel.PAR.level},
+#endif
+#ifdef OZONEEXPANSION
+	{JSON_OZO,&ReefAngel.Params.Ozone},
+#endif
+#ifdef CO2EXPANSION
+	{JSON_CO2,&ReefAngel.Co2.co2}, {JSON_CO2HUM,&ReefAngel.Co2.co2Humidity},
+#endif
+#ifdef RA_STAR
+	{JSON_CEXP0,&ReefAngel.CustomExpansionValue[0]}, {JSON_CEXP1,&ReefAngel.CustomExpansionValue[1]},
+	{JSON_CEXP2,&ReefAngel.CustomExpansionValue[2]}, {JSON_CEXP3,&ReefAngel.CustomExpansionValue[3]},
+	{JSON_CEXP4,&ReefAngel.CustomExpansionValue[4]}, {JSON_CEXP5,&ReefAngel.CustomExpansionValue[5]},
+	{JSON_CEXP6,&ReefAngel.CustomExpansionValue[6]}, {JSON_CEXP7,&ReefAngel.CustomExpansionValue[7]},
+#endif
+};
+
+#define NumParamByte	SIZE(ParamByte)
+#define NumParamInt		SIZE(ParamInt)
+static byte OldParamByte[NumParamByte];
+static int OldParamInt[NumParamInt];
+static byte ParamDirty[NumParamByte+NumParamInt];  // one bit per PARAM_ consumer
+static byte ParamCursor[PARAM_CONSUMERS];
+
+boolean ReefAngelClass::NextChangedParam(char *buffer, byte size, byte consumer)
+{
+	// Formats the next parameter this consumer has not seen yet as "name:value".
+	// Each consumer has its own dirty bit and cursor, so the cloud and /events don't take
+	// changes from each other. False means nothing else changed or the next pair does not
+	// fit in size bytes. A pair that does not fit stays pending.
+	char pair[15];
+	byte mask=1<<consumer;
+	for (byte a=0; a<NumParamByte+NumParamInt; a++)
+	{
+		byte i=ParamCursor[consumer]++;
+		if (ParamCursor[consumer]==NumParamByte+NumParamInt) ParamCursor[consumer]=0;
+		int value;
+		if (i<NumParamByte)
+		{
+			value=*(byte*)pgm_read_ptr(&ParamByte[i].value);
+			if (value!=OldParamByte[i]) { OldParamByte[i]=value; ParamDirty[i]=0xFF; }
+			if (!(ParamDirty[i]&mask)) continue;
+			strcpy_P(pair, (char*)pgm_read_ptr(&ParamByte[i].name));
+		}
+		else
+		{
+			value=*(int*)pgm_read_ptr(&ParamInt[i-NumParamByte].value);
+			if (value!=OldParamInt[i-NumParamByte]) { OldParamInt[i-NumParamByte]=value; ParamDirty[i]=0xFF; }
+			if (!(ParamDirty[i]&mask)) continue;
+			strcpy_P(pair, (char*)pgm_read_ptr(&ParamInt[i-NumParamByte].name));
+		}
+		sprintf(pair+strlen(pair), ":%d", value);
+		if (strlen(pair)>=size) { ParamCursor[consumer]=i; return false; }
+		ParamDirty[i]&=~mask;
+		strcpy(buffer, pair);
+		return true;
+	}
+	return false;
+}
+
+void ReefAngelClass::RequeueParam(byte consumer)
+{
+	// Puts back the pair NextChangedParam returned last, it is returned first next time
+	byte i=ParamCursor[consumer] ? ParamCursor[consumer]-1 : NumParamByte+NumParamInt-1;
+	ParamDirty[i]|=1<<consumer;
+	ParamCursor[consumer]=i;
+}
+
+byte ReefAngelClass::ChangedParamFrame(char *buffer, byte size, byte consumer)
+{
+	// Packs changed pairs into buffer separated by commas, returns the frame length
+	byte len=0;
+	while (len<size-1 && NextChangedParam(buffer+len, size-len, consumer))
+	{
+		len+=strlen(buffer+len);
+		buffer[len++]=',';
+	}
+	if (len) buffer[--len]=0;
+	return len;
+}
+
+void ReefAngelClass::InvalidateParams(byte consumer)
+{
+	for (byte a=0; a<NumParamByte+NumParamInt; a++)
+		ParamDirty[a]|=1<<consumer;
+}
+
+void ReefAngelClass::InvalidateParam(void *value, byte consumer)
+{
+	for (byte a=0; a<NumParamByte; a++)
+		if ((byte*)pgm_read_ptr(&ParamByte[a].value)==value) ParamDirty[a]|=1<<consumer;
+	for (byte a=0; a<NumParamInt; a++)
+		if ((int*)pgm_read_ptr(&ParamInt[a].value)==value) ParamDirty[NumParamByte+a]|=1<<consumer;
+}
+
+// Binary status record
+// version, byte param count, int param count, byte params, int params (little endian)
+// The order follows the registry above, ParamName() gives the names for the schema.
+byte ReefAngelClass::StatusRecordSize()
+{
+	return 3+NumParamByte+(NumParamInt*2);
+}
+
+byte ReefAngelClass::StatusRecordByte(byte offset)
+{
+	if (offset==0) return STATUS_RECORD_VERSION;
+	if (offset==1) return NumParamByte;
+	if (offset==2) return NumParamInt;
+	offset-=3;
+	if (offset<NumParamByte) return *(byte*)pgm_read_ptr(&ParamByte[offset].value);
+	offset-=NumParamByte;
+	int value=*(int*)pgm_read_ptr(&ParamInt[offset/2].value);
+	return (offset&1) ? highByte(value) : lowByte(value);
+}
+
+const char *ReefAngelClass::ParamName(byte index)
+{
+	if (index<NumParamByte) return (const char*)pgm_read_ptr(&ParamByte[index].name);
+	return (const char*)pgm_read_ptr(&ParamInt[index-NumParamByte].name);
+}
+#endif  // wifi || CLOUD_WIFI || ETH_WIZ5100
+
 #if defined wifi || defined ETH_WIZ5100
 #ifdef ETH_WIZ5100
 void ReefAngelClass::Portal()
@@ -1980,37 +2208,39 @@ void ReefAngelClass::Portal(char *username, char *key)
 void ReefAngelClass::CloudPortal()
 {
 	Network.Portal(CLOUD_USERNAME);
-	if (millis()-LastCloudCheck>1000 && !Network.BlockCloud())
+}
+
+void ReefAngelClass::CloudPush()
+{
+	if (!Network.BlockCloud())
 	{
-		LastCloudCheck=millis();
-		for (byte a=0; a<NumParamByte;a++)
+#ifdef CLOUD_BATCH
+		// Changed parameters are sent as a single frame per cycle, pairs separated by commas
+		// CLOUD:T1:785,T2:790,PH:812
+		// Needs attachment firmware that splits frames on commas.
+		// Pairs that do not fit in CLOUD_FRAME_SIZE go out on the next cycle.
+		char buffer[CLOUD_FRAME_SIZE];
+		if (ChangedParamFrame(buffer, sizeof(buffer)))
 		{
-			if (*ReefAngel.ParamArrayByte[a]!=ReefAngel.OldParamArrayByte[a])
-			{
-				char buffer[15];
-				strcpy_P(buffer, (char*)pgm_read_word(&(param_items_byte[a])));
-				sprintf(buffer, "%s:%d", buffer, *ReefAngel.ParamArrayByte[a]);
-				Serial.print(F("CLOUD:"));
-				Serial.println(buffer);
-				ReefAngel.OldParamArrayByte[a]=*ReefAngel.ParamArrayByte[a];
-				delay(10);
-				wdt_reset();
-			}
+			Serial.print(F("CLOUD:"));
+			Serial.println(buffer);
 		}
-		for (byte a=0; a<NumParamInt;a++)
+#else  // CLOUD_BATCH
+		// One CLOUD:name:value line per changed parameter, paced like before so the
+		// attachment has time to forward each line.
+		// About CLOUD_FRAME_SIZE bytes go out per cycle, the rest waits for the next one,
+		// so a burst of changes costs a few paced lines per second instead of all at once.
+		char buffer[15];
+		byte sent=0;
+		while (sent<CLOUD_FRAME_SIZE && NextChangedParam(buffer))
 		{
-			if (*ReefAngel.ParamArrayInt[a]!=ReefAngel.OldParamArrayInt[a])
-			{
-				char buffer[15];
-				strcpy_P(buffer, (char*)pgm_read_word(&(param_items_int[a])));
-				sprintf(buffer, "%s:%d", buffer, *ReefAngel.ParamArrayInt[a]);
-				Serial.print(F("CLOUD:"));
-				Serial.println(buffer);
-				ReefAngel.OldParamArrayInt[a]=*ReefAngel.ParamArrayInt[a];
-				delay(10);
-				wdt_reset();
-			}
+			Serial.print(F("CLOUD:"));
+			Serial.println(buffer);
+			sent+=strlen(buffer)+8;
+			delay(10);
+			wdt_reset();
 		}
+#endif  // CLOUD_BATCH
 	}
 }
 #endif // CLOUD_WIFI
@@ -2362,91 +2592,91 @@ void SendMaster(byte ID, byte data1, byte data2)
 #endif //  RA_TOUCHDISPLAY
 
 #ifdef I2CMASTER
-void ReefAngelClass::UpdateTouchDisplay()
+void ReefAngelClass::MasterUpdate()
 {
-	if (millis()-lastmasterupdate>1000)
-	{
-		lastmasterupdate=millis();
-		byte atostatus=0;
-		if (ReefAngel.LowATO.IsActive())
-			bitSet(atostatus,0);
-		else
-			bitClear(atostatus,0);
-		if (ReefAngel.HighATO.IsActive())
-			bitSet(atostatus,1);
-		else
-			bitClear(atostatus,1);
+	byte atostatus=0;
+	if (ReefAngel.LowATO.IsActive())
+		bitSet(atostatus,0);
+	else
+		bitClear(atostatus,0);
+	if (ReefAngel.HighATO.IsActive())
+		bitSet(atostatus,1);
+	else
+		bitClear(atostatus,1);
 #ifdef RA_STAR
-		if (ReefAngel.AlarmInput.IsActive())
-			bitSet(atostatus,2);
-		else
-			bitClear(atostatus,2);
+	if (ReefAngel.AlarmInput.IsActive())
+		bitSet(atostatus,2);
+	else
+		bitClear(atostatus,2);
 #endif // RA_STAR
 #if defined RA_STAR || defined LEAKDETECTOREXPANSION
-		if (ReefAngel.IsLeakDetected())
-			bitSet(atostatus,3);
-		else
-			bitClear(atostatus,3);
+	if (ReefAngel.IsLeakDetected())
+		bitSet(atostatus,3);
+	else
+		bitClear(atostatus,3);
 #endif // defined RA_STAR || defined LEAKDETECTOREXPANSION
 
-		MasterWrite(DisplayedMenu,0);
-		MasterWrite(Board,1);
-		MasterWrite(AlertFlags,2);
-		MasterWrite(StatusFlags,3);
-		MasterWrite(Params.Temp[T1_PROBE],4);
-		MasterWrite(Params.Temp[T2_PROBE],6);
-		MasterWrite(Params.Temp[T3_PROBE],8);
-		MasterWrite(Params.PH,10);
-		MasterWrite(atostatus,12);
-		MasterWrite(PWM.GetDaylightValue(),13);
-		MasterWrite(PWM.GetActinicValue(),14);
-		MasterWrite(PWM.GetDaylight2Value(),15);
-		MasterWrite(PWM.GetActinic2Value(),16);
-		MasterWrite(Relay.RelayData,17);
-		MasterWrite(Relay.RelayMaskOn,18);
-		MasterWrite(Relay.RelayMaskOff,19);
-		for (int a=0;a<PWM_EXPANSION_CHANNELS;a++)
-			MasterWrite(PWM.GetChannelValue(a),20+a);
-		MasterWrite(RF.Mode,26);
-		MasterWrite(RF.Speed,27);
-		MasterWrite(RF.Duration,28);
-		for (int a=0;a<RF_CHANNELS;a++)
-			MasterWrite(RF.RadionChannels[a],29+a);
-		MasterWrite(AI.GetChannel(0),35);
-		MasterWrite(AI.GetChannel(1),36);
-		MasterWrite(AI.GetChannel(2),37);
-		MasterWrite(IO.IOPorts,38);
-		MasterWrite(DCPump.Mode,39);
-		MasterWrite(DCPump.Speed,40);
-		MasterWrite(DCPump.Duration,41);
-		for (int a=0;a<MAX_RELAY_EXPANSION_MODULES;a++)
-		{
-			MasterWrite(Relay.RelayDataE[a],42+(a*3));
-			MasterWrite(Relay.RelayMaskOnE[a],43+(a*3));
-			MasterWrite(Relay.RelayMaskOffE[a],44+(a*3));
-		}
-		MasterWrite(Params.Salinity,66);
-		MasterWrite(Params.ORP,68);
-		MasterWrite(Params.PHExp,70);
-		MasterWrite(Humidity.GetLevel(),72);
-		MasterWrite(WaterLevel.GetLevel(),74);
-		MasterWrite(WaterLevel.GetLevel(1),76);
-		MasterWrite(WaterLevel.GetLevel(2),78);
-		MasterWrite(WaterLevel.GetLevel(3),80);
-		MasterWrite(WaterLevel.GetLevel(4),82);
-		MasterWrite(EM,84);
-		MasterWrite(EM1,85);
-		MasterWrite(REM,86);
+	MasterWrite(DisplayedMenu,0);
+	MasterWrite(Board,1);
+	MasterWrite(AlertFlags,2);
+	MasterWrite(StatusFlags,3);
+	MasterWrite(Params.Temp[T1_PROBE],4);
+	MasterWrite(Params.Temp[T2_PROBE],6);
+	MasterWrite(Params.Temp[T3_PROBE],8);
+	MasterWrite(Params.PH,10);
+	MasterWrite(atostatus,12);
+	MasterWrite(PWM.GetDaylightValue(),13);
+	MasterWrite(PWM.GetActinicValue(),14);
+	MasterWrite(PWM.GetDaylight2Value(),15);
+	MasterWrite(PWM.GetActinic2Value(),16);
+	MasterWrite(Relay.RelayData,17);
+	MasterWrite(Relay.RelayMaskOn,18);
+	MasterWrite(Relay.RelayMaskOff,19);
+	for (int a=0;a<PWM_EXPANSION_CHANNELS;a++)
+		MasterWrite(PWM.GetChannelValue(a),20+a);
+	MasterWrite(RF.Mode,26);
+	MasterWrite(RF.Speed,27);
+	MasterWrite(RF.Duration,28);
+	for (int a=0;a<RF_CHANNELS;a++)
+		MasterWrite(RF.RadionChannels[a],29+a);
+	MasterWrite(AI.GetChannel(0),35);
+	MasterWrite(AI.GetChannel(1),36);
+	MasterWrite(AI.GetChannel(2),37);
+	MasterWrite(IO.IOPorts,38);
+	MasterWrite(DCPump.Mode,39);
+	MasterWrite(DCPump.Speed,40);
+	MasterWrite(DCPump.Duration,41);
+	for (int a=0;a<MAX_RELAY_EXPANSION_MODULES;a++)
+	{
+		MasterWrite(Relay.RelayDataE[a],42+(a*3));
+		MasterWrite(Relay.RelayMaskOnE[a],43+(a*3));
+		MasterWrite(Relay.RelayMaskOffE[a],44+(a*3));
+	}
+	MasterWrite(Params.Salinity,66);
+	MasterWrite(Params.ORP,68);
+	MasterWrite(Params.PHExp,70);
+	MasterWrite(Humidity.GetLevel(),72);
+	MasterWrite(WaterLevel.GetLevel(),74);
+	MasterWrite(WaterLevel.GetLevel(1),76);
+	MasterWrite(WaterLevel.GetLevel(2),78);
+	MasterWrite(WaterLevel.GetLevel(3),80);
+	MasterWrite(WaterLevel.GetLevel(4),82);
+	MasterWrite(EM,84);
+	MasterWrite(EM1,85);
+	MasterWrite(REM,86);
 #ifdef CUSTOM_VARIABLES
 	for ( byte EID = 0; EID < 8; EID++ )
 		MasterWrite(CustomVar[EID],87+EID);
-		// Don't go over 99. The max array is set to 100
+	// Don't go over 99. The max array is set to 100
 
 #endif //CUSTOM_VARIABLES
-      MasterWrite(Params.Ozone, 95);
-	  MasterWrite(Co2.co2ppm,96);
-	  MasterWrite(Co2.co2Humidity, 97);
-	}
+	MasterWrite(Params.Ozone, 95);
+	MasterWrite(Co2.co2ppm,96);
+	MasterWrite(Co2.co2Humidity, 97);
+}
+
+void ReefAngelClass::UpdateTouchDisplay()
+{
 	if (DisplayedMenu==FEEDING_MODE)
 	{
 		// ID 0 - Feeding Timer
@@ -2690,117 +2920,92 @@ void ReefAngelClass::SetDCPumpChannels(byte SyncSpeed, byte AntiSyncSpeed)
 #endif // DCPUMPCONTROL
 
 #if defined RA_STAR || defined CLOUD_WIFI
-void MQTTSubCallback(char* topic, byte* payload, unsigned int length) {
-  // handle message arrived
-	char mqtt_sub[12];
-	byte starti=0;
-	int mqtt_val=0;
-	long mqtt_val1=0;
-	byte mqtt_type=MQTT_NONE;
-	boolean foundchannel=false;
+// Cloud command tokens, looked up with a binary search by MQTTLookup().
+// Keep this table sorted in strcmp order when adding commands.
+typedef struct
+{
+	char name[8];
+	byte type;
+} MQTTCommand;
+
+static const MQTTCommand MQTTCommands[] PROGMEM = {
+	{"all",MQTT_REQUESTALL}, {"avs",MQTT_ALEXA}, {"bin",MQTT_BINARY}, {"boot",MQTT_REBOOT}, {"calcus1",MQTT_CALCUS1},
+	{"calcus2",MQTT_CALCUS2}, {"calcus3",MQTT_CALCUS3}, {"calcus4",MQTT_CALCUS4}, {"calcus5",MQTT_CALCUS5},
+	{"calcus6",MQTT_CALCUS6}, {"calcus7",MQTT_CALCUS7}, {"calcus8",MQTT_CALCUS8}, {"calorp",MQTT_CALORP},
+	{"calph",MQTT_CALPH}, {"calphe",MQTT_CALPHE}, {"calsal",MQTT_CAlSAL}, {"calwl",MQTT_CALWL},
+	{"calwl1",MQTT_CALWL1}, {"calwl2",MQTT_CALWL2}, {"calwl3",MQTT_CALWL3}, {"calwl4",MQTT_CALWL4},
+	{"cexp",MQTT_CUSTOM_EXP}, {"cexpc",MQTT_CUSTOM_CALIBRATION}, {"co2",MQTT_CO2}, {"co2hum",MQTT_CO2HUM},
+	{"cvar",MQTT_CVAR}, {"date",MQTT_DATE}, {"hum",MQTT_HUM}, {"io",MQTT_IO}, {"l",MQTT_LIGHTS},
+	{"leak",MQTT_LEAK}, {"mb",MQTT_MEM_BYTE}, {"mf",MQTT_MODE_FEEDING}, {"mi",MQTT_MEM_INT},
+	{"ml",MQTT_ALARM_LEAK}, {"mo",MQTT_ALARM_OVERHEAT}, {"mr",MQTT_MEM_RAW}, {"mt",MQTT_ALARM_ATO},
+	{"mw",MQTT_MODE_WATERCHANGE}, {"orp",MQTT_ORP}, {"orpc",MQTT_CALIBRATION}, {"ozo",MQTT_OZONE},
+	{"par",MQTT_PAR}, {"phe",MQTT_PHEXP}, {"phec",MQTT_CALIBRATION}, {"po",MQTT_OVERRIDE},
+	{"prof",MQTT_PROFILER}, {"r",MQTT_R}, {"sal",MQTT_SALINITY}, {"salc",MQTT_CALIBRATION}, {"t",MQTT_T},
+	{"v",MQTT_VERSION}, {"wl",MQTT_WL}, {"wlc",MQTT_CALIBRATION}
+};
 
-	for (int a=0;a<length;a++)
+byte MQTTLookup(const char *token)
+{
+	byte lo=0;
+	byte hi=SIZE(MQTTCommands);
+	while (lo<hi)
 	{
-#ifdef RA_STAR
-		Serial.write(payload[a]);
-#endif
-		if (starti==0)
-		{
-			mqtt_sub[a]=payload[a];
-			if (payload[a]==58) // Let's look for a :
-			{
-				mqtt_sub[a]=0;
-				starti=a;
-				if (strcmp("all", mqtt_sub)==0) mqtt_type=MQTT_REQUESTALL;
-				else if (strcmp("t", mqtt_sub)==0) mqtt_type=MQTT_T;
-				else if (strcmp("r", mqtt_sub)==0) mqtt_type=MQTT_R;
-				else if (strcmp("mf", mqtt_sub)==0) mqtt_type=MQTT_MODE_FEEDING;
-				else if (strcmp("mw", mqtt_sub)==0) mqtt_type=MQTT_MODE_WATERCHANGE;
-				else if (strcmp("mt", mqtt_sub)==0) mqtt_type=MQTT_ALARM_ATO;
-				else if (strcmp("mo", mqtt_sub)==0) mqtt_type=MQTT_ALARM_OVERHEAT;
-				else if (strcmp("ml", mqtt_sub)==0) mqtt_type=MQTT_ALARM_LEAK;
-				else if (strcmp("l", mqtt_sub)==0) mqtt_type=MQTT_LIGHTS;
-				else if (strcmp("boot", mqtt_sub)==0) mqtt_type=MQTT_REBOOT;
-				else if (strcmp("sal", mqtt_sub)==0) mqtt_type=MQTT_SALINITY;
-				else if (strcmp("salc", mqtt_sub)==0) mqtt_type=MQTT_CALIBRATION;
-				else if (strcmp("orp", mqtt_sub)==0) mqtt_type=MQTT_ORP;
-				else if (strcmp("orpc", mqtt_sub)==0) mqtt_type=MQTT_CALIBRATION;
-				else if (strcmp("phe", mqtt_sub)==0) mqtt_type=MQTT_PHEXP;
-				else if (strcmp("phec", mqtt_sub)==0) mqtt_type=MQTT_CALIBRATION;
-				else if (strcmp("cexp", mqtt_sub)==0) mqtt_type=MQTT_CUSTOM_EXP;
-				else if (strcmp("cexpc", mqtt_sub)==0) mqtt_type=MQTT_CUSTOM_CALIBRATION;
-				else if (strcmp("io", mqtt_sub)==0) mqtt_type=MQTT_IO;
-				else if (strcmp("wl", mqtt_sub)==0) mqtt_type=MQTT_WL;
-				else if (strcmp("wlc", mqtt_sub)==0) mqtt_type=MQTT_CALIBRATION;
-				else if (strcmp("leak", mqtt_sub)==0) mqtt_type=MQTT_LEAK;
-				else if (strcmp("par", mqtt_sub)==0) mqtt_type=MQTT_PAR;
-				else if (strcmp("hum", mqtt_sub)==0) mqtt_type=MQTT_HUM;
-				else if (strcmp("po", mqtt_sub)==0) mqtt_type=MQTT_OVERRIDE;
-				else if (strcmp("cvar", mqtt_sub)==0) mqtt_type=MQTT_CVAR;
-				else if (strcmp("mb", mqtt_sub)==0) mqtt_type=MQTT_MEM_BYTE;
-				else if (strcmp("mi", mqtt_sub)==0) mqtt_type=MQTT_MEM_INT;
-				else if (strcmp("date", mqtt_sub)==0) mqtt_type=MQTT_DATE;
-				else if (strcmp("v", mqtt_sub)==0) mqtt_type=MQTT_VERSION;
-				else if (strcmp("mr", mqtt_sub)==0) mqtt_type=MQTT_MEM_RAW;
-				else if (strcmp("avs", mqtt_sub)==0) mqtt_type=MQTT_ALEXA;
-				//for ozone cloud update
-				else if (strcmp("ozo", mqtt_sub)==0) mqtt_type=MQTT_OZONE;
-				else if (strcmp("co2", mqtt_sub)==0) mqtt_type=MQTT_CO2;
-				else if (strcmp("co2hum", mqtt_sub)==0) mqtt_type=MQTT_CO2HUM;
-				// co2 cloud update 
-				//for display calibration screen 
-				else if (strcmp("calph", mqtt_sub)==0) mqtt_type=MQTT_CALPH;
-				else if (strcmp("calorp", mqtt_sub)==0) mqtt_type=MQTT_CALORP;
-				else if (strcmp("calsal", mqtt_sub)==0) mqtt_type=MQTT_CAlSAL;
-                else if (strcmp("calphe", mqtt_sub)==0) mqtt_type=MQTT_CALPHE;
-				else if (strcmp("calwl", mqtt_sub)==0) mqtt_type=MQTT_CALWL;
-				else if (strcmp("calwl1", mqtt_sub)==0) mqtt_type=MQTT_CALWL1;
-				else if (strcmp("calwl2", mqtt_sub)==0) mqtt_type=MQTT_CALWL2;
-				else if (strcmp("calwl3", mqtt_sub)==0) mqtt_type=MQTT_CALWL3;
-				else if (strcmp("calwl4", mqtt_sub)==0) mqtt_type=MQTT_CALWL4;
-				//display custom Calibration screen
-				else if (strcmp("calcus1", mqtt_sub)==0) mqtt_type=MQTT_CALCUS1;
-				else if (strcmp("calcus2", mqtt_sub)==0) mqtt_type=MQTT_CALCUS2;
-				else if (strcmp("calcus3", mqtt_sub)==0) mqtt_type=MQTT_CALCUS3;
-				else if (strcmp("calcus4", mqtt_sub)==0) mqtt_type=MQTT_CALCUS4;
-				else if (strcmp("calcus5", mqtt_sub)==0) mqtt_type=MQTT_CALCUS5;
-				else if (strcmp("calcus6", mqtt_sub)==0) mqtt_type=MQTT_CALCUS6;
-				else if (strcmp("calcus7", mqtt_sub)==0) mqtt_type=MQTT_CALCUS7;
-				else if (strcmp("calcus8", mqtt_sub)==0) mqtt_type=MQTT_CALCUS8;
-				
-			}
-		}
-		else
+		byte mid=(lo+hi)/2;
+		int c=strcmp_P(token, MQTTCommands[mid].name);
+		if (c==0) return pgm_read_byte(&MQTTCommands[mid].type);
+		if (c<0) hi=mid; else lo=mid+1;
+	}
+	return MQTT_NONE;
+}
+
+static void MQTTRun(byte mqtt_type, int mqtt_val, long mqtt_val1);
+
+static void MQTTParseValues(byte* payload, unsigned int length, int &mqtt_val, long &mqtt_val1)
+{
+	// "value" or "value:value1", anything but digits is skipped
+	boolean foundchannel=false;
+	mqtt_val=0;
+	mqtt_val1=0;
+	for (unsigned int a=0;a<length;a++)
+	{
+		if (payload[a]==':')
+			foundchannel=true;
+		else if (payload[a]>='0' && payload[a]<='9')
 		{
-			if (payload[a]==58) // Let's look for a :
-			{
-				foundchannel=true;
-				//mqtt_val=0;
-			}
+			if (!foundchannel)
+				mqtt_val=mqtt_val*10+(payload[a]-'0');
 			else
-			{
-				if (!foundchannel)
-				{
-					if (payload[a]!=0)
-					{
-						mqtt_val*=10;
-						mqtt_val+=(payload[a]-'0');
-					}
-				}
-				else
-				{
-					if (payload[a]!=0)
-					{
-						mqtt_val1*=10;
-						mqtt_val1+=(payload[a]-'0');
-					}
-				}
-			}
+				mqtt_val1=mqtt_val1*10+(payload[a]-'0');
 		}
 	}
+}
+
+static void MQTTSubHandle(char* topic, byte* payload, unsigned int length) {
+  // handle message arrived
+	char mqtt_sub[12];
+	unsigned int a;
+	int mqtt_val=0;
+	long mqtt_val1=0;
+	byte mqtt_type=MQTT_NONE;
+
 #ifdef RA_STAR
+	Serial.write(payload,length);
 	Serial.println(F(" "));
 #endif
+	// "command:value:value1", the command runs up to the first ':'
+	for (a=0;a<length && a<sizeof(mqtt_sub) && payload[a]!=':';a++)
+		mqtt_sub[a]=payload[a];
+	if (a<length && a<sizeof(mqtt_sub)) // token too long for any command otherwise
+	{
+		mqtt_sub[a]=0;
+		mqtt_type=MQTTLookup(mqtt_sub);
+		MQTTParseValues(payload+a+1, length-a-1, mqtt_val, mqtt_val1);
+	}
+	MQTTRun(mqtt_type, mqtt_val, mqtt_val1);
+}
+
+static void MQTTRun(byte mqtt_type, int mqtt_val, long mqtt_val1)
+{
 	switch (mqtt_type)
 
 	{ 
@@ -2813,14 +3018,7 @@ void MQTTSubCallback(char* topic, byte* payload, unsigned int length) {
 			ReefAngel.CheckOverride(mqtt_val);
 			break;
 		case MQTT_REQUESTALL:
-			for (byte a=0; a<NumParamByte;a++)
-			{
-				ReefAngel.OldParamArrayByte[a]=ReefAngel.OldParamArrayByte[a]+1;
-			}
-			for (byte a=0; a<NumParamInt;a++)
-			{
-				ReefAngel.OldParamArrayInt[a]=ReefAngel.OldParamArrayInt[a]+1;
-			}
+			ReefAngel.InvalidateParams();
 			break;
 		case MQTT_MODE_FEEDING:
 		{
@@ -3084,20 +3282,69 @@ void MQTTSubCallback(char* topic, byte* payload, unsigned int length) {
 			}
 			break;
 		}
-		case MQTT_ALEXA:
+#ifdef REFRESH_PROFILER
+		case MQTT_PROFILER:
 		{
-//			for (byte a=0; a<NumParamByte;a++)
-//			{
-//				ReefAngel.OldParamArrayByte[a]=ReefAngel.OldParamArrayByte[a]+1;
-//			}
-			for (byte a=0; a<4; a++)
+			// prof:0 reports the Refresh() stage timings, prof:1 also clears them
+			char buffer[40];
+			for (byte a=0; a<PROFILE_STAGES; a++)
 			{
-				ReefAngel.OldParamArrayInt[a]=ReefAngel.OldParamArrayInt[a]+1;
+				sprintf(buffer,"PROF%d:%lu,%lu,%lu",a,ReefAngel.Profiler.GetMin(a),ReefAngel.Profiler.GetAvg(a),ReefAngel.Profiler.GetMax(a));
+#ifdef RA_STAR
+				ReefAngel.Network.CloudPublish(buffer);
+#endif
+#ifdef CLOUD_WIFI
+				Serial.print(F("CLOUD:"));
+				Serial.println(buffer);
+				delay(10);
+				wdt_reset();
+#endif
 			}
-			ReefAngel.OldParamArrayByte[7]=ReefAngel.OldParamArrayByte[7]+1;
-			ReefAngel.OldParamArrayByte[12]=ReefAngel.OldParamArrayByte[12]+1;
-			ReefAngel.OldParamArrayByte[13]=ReefAngel.OldParamArrayByte[13]+1;
-			ReefAngel.OldParamArrayByte[14]=ReefAngel.OldParamArrayByte[14]+1;
+			sprintf(buffer,"LMAX:%lu,LOVR:%u",ReefAngel.Profiler.LoopMax,ReefAngel.Profiler.Overruns);
+#ifdef RA_STAR
+			ReefAngel.Network.CloudPublish(buffer);
+#endif
+#ifdef CLOUD_WIFI
+			Serial.print(F("CLOUD:"));
+			Serial.println(buffer);
+#endif
+			if (mqtt_val==1) ReefAngel.Profiler.Reset();
+			break;
+		}
+#endif // REFRESH_PROFILER
+		case MQTT_BINARY:
+		{
+#ifdef RA_STAR
+			// The whole record is streamed as one BIN0:<hex> message
+			ReefAngel.Network.CloudPublishStatusRecord();
+#endif
+#ifdef CLOUD_WIFI
+			// bin:0 sends the binary status record hex encoded, BIN<offset>:<hex> per 24 bytes
+			char buffer[60];
+			byte size=ReefAngel.StatusRecordSize();
+			for (byte offset=0; offset<size; offset+=24)
+			{
+				sprintf(buffer,"BIN%d:",offset);
+				for (byte a=offset; a<size && a<offset+24; a++)
+					sprintf(buffer+strlen(buffer),"%02X",ReefAngel.StatusRecordByte(a));
+				Serial.print(F("CLOUD:"));
+				Serial.println(buffer);
+			}
+#endif
+			break;
+		}
+		case MQTT_ALEXA:
+		{
+			ReefAngel.InvalidateParam(&ReefAngel.Params.Temp[T1_PROBE]);
+			ReefAngel.InvalidateParam(&ReefAngel.Params.Temp[T2_PROBE]);
+			ReefAngel.InvalidateParam(&ReefAngel.Params.Temp[T3_PROBE]);
+			ReefAngel.InvalidateParam(&ReefAngel.Params.PH);
+			ReefAngel.InvalidateParam(&ReefAngel.StatusFlags);
+#ifdef RelayExp
+			ReefAngel.InvalidateParam(&ReefAngel.Relay.RelayDataE[0]);
+			ReefAngel.InvalidateParam(&ReefAngel.Relay.RelayMaskOffE[0]);
+			ReefAngel.InvalidateParam(&ReefAngel.Relay.RelayMaskOnE[0]);
+#endif  // RelayExp
 			break;
 		}
 #ifdef RA_STAR		
@@ -3349,6 +3596,30 @@ case MQTT_CALPH:
     
    }
 }
+
+void MQTTSubCallback(char* topic, byte* payload, unsigned int length) {
+	// Each command is timed on its own, prof:0 reports it with the Refresh() stages
+#ifdef REFRESH_PROFILER
+	unsigned long start=micros();
+#endif  // REFRESH_PROFILER
+	MQTTSubHandle(topic, payload, length);
+	PROFILE_SAMPLE(PROFILE_COMMAND, start);
+}
+
+#ifdef RA_STAR
+void MQTTTopicCallback(char* topic, byte* payload, unsigned int length) {
+	// <user>/in/<command> carries only "value" or "value:value1",
+	// the command comes from the last topic level instead of the payload
+#ifdef REFRESH_PROFILER
+	unsigned long start=micros();
+#endif  // REFRESH_PROFILER
+	int mqtt_val;
+	long mqtt_val1;
+	MQTTParseValues(payload, length, mqtt_val, mqtt_val1);
+	MQTTRun(MQTTLookup(strrchr(topic,'/')+1), mqtt_val, mqtt_val1);
+	PROFILE_SAMPLE(PROFILE_COMMAND, start);
+}
+#endif  // RA_STAR
 #endif // RA_STAR
 void ReefAngelClass::CheckOverride(int option)
 {
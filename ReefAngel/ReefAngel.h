@@ -30,6 +30,7 @@
 #include <RA_ATO.h>
 #include <LED.h>
 #include <RA_TempSensor.h>
+#include <RA_Sampler.h>
 #include <Relay.h>
 #ifdef SC16IS750
 #include <RA_SC16IS750.h>
@@ -38,6 +39,7 @@
 #include <RA_PWM.h>
 #endif  // DisplayLEDPWM
 #include <Timer.h>
+#include <RA_Scheduler.h>
 #include <Memory.h>
 #ifdef DCPUMPCONTROL
 #include <DCPump.h>
@@ -79,6 +81,9 @@
 #if defined CO2EXPANSION
 #include <Co2.h>
 #endif //Defined Co2 Expansion
+#ifdef REFRESH_PROFILER
+#include <RA_Profiler.h>
+#endif  // REFRESH_PROFILER
 #include <RA_CustomLabels.h>
 #include <RA_CustomSettings.h>
 
@@ -133,6 +138,7 @@ public:
 	RA_KalkDoserClass KWDoser;
 #endif //  KALKDOSER
 	RA_TempSensorClass TempSensor;
+	RA_SamplerClass PHSamples;
 #ifndef SC16IS750
   RelayClass Relay;
 #else
@@ -158,14 +164,17 @@ public:
 #if defined ORPEXPANSION
 	int ORPMin, ORPMax;
 	ORPClass ORP;
+	RA_SamplerClass ORPSamples;
 #endif  // ORPEXPANSION
 #if defined SALINITYEXPANSION
 	int SalMax;
 	SalinityClass Salinity;
+	RA_SamplerClass SalinitySamples;
 #endif  // defined SALINITYEXPANSION
 #if defined PHEXPANSION
 	int PHExpMin, PHExpMax;
 	PHClass PH;
+	RA_SamplerClass PHExpSamples;
 #endif  // PHEXPANSION	
 #if defined WATERLEVELEXPANSION || defined MULTIWATERLEVELEXPANSION
 	WaterLevelClass WaterLevel;
@@ -176,6 +185,7 @@ public:
 #endif  // defined RFEXPANSION
 #if defined AI_LED
 	AIClass AI;
+	byte AITaskID;
 #endif  // defined AI_LED
 #if defined IOEXPANSION
 	IOClass IO;
@@ -193,6 +203,9 @@ public:
 #if defined CO2EXPANSION
   Co2Sensor Co2; // Correctly create an instance of the Co2Sensor class
 #endif // Co2Expansion
+#ifdef REFRESH_PROFILER
+	RA_ProfilerClass Profiler;
+#endif  // REFRESH_PROFILER
 	/*
 	Timers:
 	0 - Feeding Mode timer
@@ -203,6 +216,7 @@ public:
 	5 - Store params to eeprom
 	 */
 	TimerClass Timer[6];
+	RA_SchedulerClass Scheduler;
 	byte SelectedMenuItem;
 	byte DisplayedMenu;
 	bool showmenu;
@@ -272,11 +286,6 @@ public:
 #ifdef LEAKDETECTOREXPANSION
 	time_t Leakmillis;
 #endif  // LEAKDETECTOREXPANSION
-#if defined wifi || defined CLOUD_WIFI || defined ETH_WIZ5100
-	byte CloudDummyByte;
-	int CloudDummyInt;
-	unsigned long LastCloudCheck;
-#endif
 
 	void Init();
 	void Refresh();
@@ -303,6 +312,7 @@ public:
 	void Reboot();
 #ifdef RANET
 	void RANetTrigger(byte TriggerValue);
+	void RANetSend();
 #endif // RANET
 #ifdef DCPUMPCONTROL
 	void SetDCPumpChannels(byte SyncSpeed,byte AntiSyncSpeed);
@@ -317,117 +327,15 @@ public:
 #endif // RA_STAR 
 	
 #if defined wifi || defined CLOUD_WIFI || defined ETH_WIZ5100
-	byte* ParamArrayByte[NumParamByte] = {&LowATO.Status,&HighATO.Status,&EM,&EM1,&REM,&Board,&AlertFlags,&StatusFlags,
-
-#if defined DisplayLEDPWM && ! defined RemoveAllLights || defined DCPUMPCONTROL
-	&PWM.DaylightPercentage,&PWM.ActinicPercentage,&PWM.DaylightPWMOverride,&PWM.ActinicPWMOverride,
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#ifdef RelayExp
-	&Relay.RelayDataE[0],&Relay.RelayMaskOffE[0],&Relay.RelayMaskOnE[0],&Relay.RelayDataE[1],&Relay.RelayMaskOffE[1],&Relay.RelayMaskOnE[1],&Relay.RelayDataE[2],&Relay.RelayMaskOffE[2],&Relay.RelayMaskOnE[2],&Relay.RelayDataE[3],&Relay.RelayMaskOffE[3],&Relay.RelayMaskOnE[3],&Relay.RelayDataE[4],&Relay.RelayMaskOffE[4],&Relay.RelayMaskOnE[4],&Relay.RelayDataE[5],&Relay.RelayMaskOffE[5],&Relay.RelayMaskOnE[5],&Relay.RelayDataE[6],&Relay.RelayMaskOffE[6],&Relay.RelayMaskOnE[6],&Relay.RelayDataE[7],&Relay.RelayMaskOffE[7],&Relay.RelayMaskOnE[7],
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#ifdef RA_STAR
-	&AlarmInput.Status,&PWM.Daylight2Percentage,&PWM.Actinic2Percentage,&PWM.Daylight2PWMOverride,&PWM.Actinic2PWMOverride,
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#if defined WATERLEVELEXPANSION || defined MULTIWATERLEVELEXPANSION
-	&WaterLevel.level[0],&WaterLevel.level[1],&WaterLevel.level[2],&WaterLevel.level[3],&WaterLevel.level[4],
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#ifdef HUMIDITYEXPANSION
-	&Humidity.level,
-#else
-	&CloudDummyByte,
-#endif
-#ifdef DCPUMPCONTROL
-	&DCPump.Mode,&DCPump.Speed,&DCPump.Duration,&DCPump.Threshold,
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#ifdef PWMEXPANSION
-	&PWM.ExpansionPercentage[0],&PWM.ExpansionPercentage[1],&PWM.ExpansionPercentage[2],&PWM.ExpansionPercentage[3],&PWM.ExpansionPercentage[4],&PWM.ExpansionPercentage[5],&PWM.ExpansionChannelOverride[0],&PWM.ExpansionChannelOverride[1],&PWM.ExpansionChannelOverride[2],&PWM.ExpansionChannelOverride[3],&PWM.ExpansionChannelOverride[4],&PWM.ExpansionChannelOverride[5],
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#ifdef AI_LED
-	&AI.AIChannels[0],&AI.AIChannels[1],&AI.AIChannels[2],
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#ifdef RFEXPANSION
-	&RF.Mode,&RF.Speed,&RF.Duration,&RF.RadionChannels[0],&RF.RadionChannels[1],&RF.RadionChannels[2],&RF.RadionChannels[3],&RF.RadionChannels[4],&RF.RadionChannels[5],&RF.RadionChannelsOverride[0],&RF.RadionChannelsOverride[1],&RF.RadionChannelsOverride[2],&RF.RadionChannelsOverride[3],&RF.RadionChannelsOverride[4],&RF.RadionChannelsOverride[5],
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-#ifdef IOEXPANSION
-	&IO.IOPorts,
-#else
-	&CloudDummyByte,
-#endif
-#if defined LEAKDETECTOREXPANSION || defined RA_STAR
-	&LeakValue,
-#else
-	&CloudDummyByte,
-#endif
-#ifdef CUSTOM_VARIABLES
-	&CustomVar[0],&CustomVar[1],&CustomVar[2],&CustomVar[3],&CustomVar[4],&CustomVar[5],&CustomVar[6],&CustomVar[7],
-#else
-	&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,&CloudDummyByte,
-#endif
-	&Relay.RelayData,&Relay.RelayMaskOff,&Relay.RelayMaskOn
-	};
-
-
-int* ParamArrayInt[NumParamInt] = {
-    &Params.Temp[T1_PROBE], &Params.Temp[T2_PROBE], &Params.Temp[T3_PROBE], &Params.PH,
-#ifdef EXTRA_TEMP_PROBES
-    &Params.Temp[T4_PROBE], &Params.Temp[T5_PROBE], &Params.Temp[T6_PROBE],
-#else
-    &CloudDummyInt, &CloudDummyInt, &CloudDummyInt,
-#endif
-#ifdef ORPEXPANSION
-    &Params.ORP,
-#else
-    &CloudDummyInt,
-#endif
-#ifdef SALINITYEXPANSION
-    &Params.Salinity,
-#else
-    &CloudDummyInt,
-#endif
-#ifdef PHEXPANSION
-    &Params.PHExp,
-#else
-    &CloudDummyInt,
-#endif
-#ifdef PAREXPANSION
-    &PAR.level,
-#else
-    &CloudDummyInt,
-#endif
-#ifdef OZONEEXPANSION
-    &Params.Ozone,
-#else
-    &CloudDummyInt,
-#endif
-#ifdef CO2EXPANSION
-  &Co2.co2, &Co2.co2Humidity,
-#else 
-  &CloudDummyInt, &CloudDummyInt,
-#endif
-#ifdef RA_STAR
-    &CustomExpansionValue[0], &CustomExpansionValue[1], &CustomExpansionValue[2], &CustomExpansionValue[3],
-    &CustomExpansionValue[4], &CustomExpansionValue[5], &CustomExpansionValue[6], &CustomExpansionValue[7]
-#endif
-};
-	byte OldParamArrayByte[NumParamByte];
-	int OldParamArrayInt[NumParamInt];
-#endif // wifi	
+	boolean NextChangedParam(char *buffer, byte size=15, byte consumer=PARAM_CLOUD);
+	void RequeueParam(byte consumer=PARAM_CLOUD);
+	byte ChangedParamFrame(char *buffer, byte size, byte consumer=PARAM_CLOUD);
+	void InvalidateParams(byte consumer=PARAM_CLOUD);
+	void InvalidateParam(void *value, byte consumer=PARAM_CLOUD);
+	byte StatusRecordSize();
+	byte StatusRecordByte(byte offset);
+	const char *ParamName(byte index);
+#endif // wifi
 	
 #ifdef I2CMASTER
 #define MASTERARRAYSIZE	100
@@ -435,7 +343,7 @@ int* ParamArrayInt[NumParamInt] = {
 	byte I2CCommand;
 	void UpdateTouchDisplay();
 	void MasterWrite(int value, byte index);
-	unsigned long lastmasterupdate;
+	void MasterUpdate();
 #endif // I2CMASTER
 
 	// Call these methods to explictly add expansion features
@@ -580,6 +488,9 @@ int* ParamArrayInt[NumParamInt] = {
 	void Portal(char *username);
 	void Portal(char *username, char *key);
 	void CloudPortal();
+#ifdef CLOUD_WIFI
+	void CloudPush();
+#endif // CLOUD_WIFI
 	void DDNS(char *subdomain);
 #endif
 	void CheckOverride(int option);
@@ -4181,7 +4181,9 @@ boolean SliderClass::Refresh()
 	if (NeedsRedraw)
 	{
 		Show();
+		return true;
 	}
+	return false;
 }
 
 boolean SliderClass::IsPlusPressed()
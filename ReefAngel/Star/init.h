@@ -61,7 +61,6 @@ lastRedraw=millis();
 lastDisplayChange=millis();
 #ifdef RANET
 RANetSeq=0;
-RANetlastmillis=millis();
 #endif
 OkButton.Create(COLOR_WHITE,COLOR_MIDNIGHTBLUE,CUSTOMLABELOKBUTTON,OKBUTTON);
 CancelButton.Create(COLOR_WHITE,COLOR_MIDNIGHTBLUE,CUSTOMLABELCANCELBUTTON,CANCELBUTTON);
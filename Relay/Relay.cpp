@@ -34,6 +34,9 @@ RelayClass::RelayClass()
 	RelayData = 0;
 	RelayMaskOn = 0;
 	RelayMaskOff = 0xff;
+	LastWrite = 0;
+	ForceRefresh = true;
+	LastRefresh = 0;
 #ifdef SaveRelaysPresent
 	// assume relay is present till we hear otherwise.
 	RelayPresent = true;
@@ -44,6 +47,7 @@ RelayClass::RelayClass()
 		RelayDataE[EID] = 0;
 		RelayMaskOnE[EID] = 0;
 		RelayMaskOffE[EID] = 0xff;
+		LastWriteE[EID] = 0;
 #ifdef SaveRelaysPresent
 		RelayPresentE[EID] = true;
 #endif  // SaveRelaysPresent
@@ -157,15 +161,30 @@ void RelayClass::Write()
 #ifndef RA_TOUCHDISPLAY
     byte TempRelay = RelayData;
 	byte present = 0;
+	boolean force = ForceRefresh;
     TempRelay &= RelayMaskOff;
     TempRelay |= RelayMaskOn;
 
-    Wire.beginTransmission(I2CExpander1);
-    Wire.write(~TempRelay);   // MSB
-    present = Wire.endTransmission();
+	// Everything is rewritten periodically in case an expander was reset and to keep presence up to date
+	if (millis()-LastRefresh >= RELAY_REFRESH_INTERVAL)
+		force = true;
+	if (force)
+	{
+		ForceRefresh = false;
+		LastRefresh = millis();
+	}
+
+	if (force || TempRelay != LastWrite)
+	{
+		Wire.beginTransmission(I2CExpander1);
+		Wire.write(~TempRelay);   // MSB
+		present = Wire.endTransmission();
+		// A NACKed write is left to the periodic refresh, a missing box isn't retried on every call
+		LastWrite = TempRelay;
 #ifdef SaveRelaysPresent
-	RelayPresent = (present == 0);
+		RelayPresent = (present == 0);
 #endif  // SaveRelaysPresent
+	}
 
 #ifdef RelayExp
 	for ( byte EID = 0; EID < MAX_RELAY_EXPANSION_MODULES; EID++ )
@@ -173,9 +192,11 @@ void RelayClass::Write()
 		TempRelay = RelayDataE[EID];
 		TempRelay &= RelayMaskOffE[EID];
 		TempRelay |= RelayMaskOnE[EID];
+		if (!force && TempRelay == LastWriteE[EID]) continue;
 		Wire.beginTransmission(I2CExpModule+EID);
 		Wire.write(~TempRelay);  // MSB
 		present = Wire.endTransmission();
+		LastWriteE[EID] = TempRelay;
 #ifdef SaveRelaysPresent
 		RelayPresentE[EID] = (present == 0);
 #endif  // SaveRelaysPresent
@@ -48,6 +48,7 @@ public:
 	boolean isMaskOn(byte ID);
 	boolean isMaskOff(byte ID);
 	void Override(byte ID, byte type);
+	inline void Refresh() { ForceRefresh=true; };
 	byte RelayData;
 	byte RelayMaskOn;
 	byte RelayMaskOff;
@@ -70,6 +71,14 @@ public:
 #endif  // SaveRelaysPresent
 #endif  // RelayExp
 
+private:
+	// last byte sent to each relay box, so Write() only talks to boxes that changed
+	byte LastWrite;
+#ifdef RelayExp
+	byte LastWriteE[MAX_RELAY_EXPANSION_MODULES];
+#endif  // RelayExp
+	boolean ForceRefresh;
+	unsigned long LastRefresh;
 };
 
 #endif  // __RELAY_H__
@@ -0,0 +1,206 @@
+// Cloud commands from the broker stand-in through PubSubClient on the emulated W5100
+// into MQTTSubCallback() and MQTTTopicCallback(), then data/cloud_replay.txt replayed
+// the same way. Latency is in virtual ms from the broker's PUBLISH to the controller's
+// reply; times are host CPU time and only useful relative to other runs.
+#include "harness.h"
+#include <stdlib.h>
+
+#define REPLAY "data/cloud_replay.txt"
+#define ROUNDS 200
+
+MQTTBroker broker;
+
+// loop() of a Star sketch with the cloud enabled, on 10 ms ticks
+void loop(unsigned long ms) {
+    for (unsigned long t = 0; t < ms; t += 10) {
+        HostAdvanceMillis(10);
+        ReefAngel.Refresh();
+        ReefAngel.Network.Cloud();
+    }
+}
+
+std::string topic(const char *level) {
+    return std::string(CLOUD_USERNAME) + "/" + level;
+}
+
+// Whether the controller published payload since the index since
+boolean published(const char *payload, size_t since) {
+    for (size_t i = since; i < broker.published.size(); i++)
+        if (broker.published[i] == payload) return true;
+    return false;
+}
+
+void testConnect() {
+    for (int i = 0; i < 1000 && !ReefAngel.Network.FoundIP; i++) loop(10);
+    loop(6000);
+    check(ReefAngel.Network.IsMQTTConnected(), "MQTT connected");
+    check(broker.subscribed == topic("in/#"), "the controller subscribed to <user>/in/#");
+}
+
+// "command:value:value1" on <user>/in, "value:value1" on <user>/in/<command>
+void testCommands() {
+    broker.publish(topic("in"), "r:31");
+    loop(20);
+    check(bitRead(ReefAngel.Relay.RelayMaskOn, 2) && bitRead(ReefAngel.Relay.RelayMaskOff, 2), "r:31 turned port 3 on");
+    broker.publish(topic("in/r"), "30");
+    loop(20);
+    check(!bitRead(ReefAngel.Relay.RelayMaskOn, 2) && !bitRead(ReefAngel.Relay.RelayMaskOff, 2),
+          "30 on in/r turned port 3 off");
+    broker.publish(topic("in"), "r:32");
+    loop(20);
+    check(!bitRead(ReefAngel.Relay.RelayMaskOn, 2) && bitRead(ReefAngel.Relay.RelayMaskOff, 2), "r:32 put port 3 back on auto");
+
+    size_t since = broker.published.size();
+    broker.publish(topic("in"), "mb:830:9");
+    loop(20);
+    check(InternalMemory.read(830) == 9, "mb:830:9 wrote the memory byte");
+    check(published("MBOK:830", since), "mb: was acknowledged with MBOK");
+    broker.publish(topic("in/mb"), "831:17");
+    loop(20);
+    check(InternalMemory.read(831) == 17, "831:17 on in/mb wrote the memory byte");
+
+    broker.publish(topic("in"), "po:1:45");
+    loop(20);
+    check(ReefAngel.PWM.GetActinicOverrideValue() == 45, "po:1:45 overrode the actinic channel");
+    broker.publish(topic("in/po"), "1:255");
+    loop(20);
+    check(ReefAngel.PWM.GetActinicOverrideValue() == 255, "1:255 on in/po cancelled the override");
+
+    byte on = ReefAngel.Relay.RelayMaskOn;
+    broker.publish(topic("in"), "nosuchcommand:31");
+    broker.publish(topic("in/zz"), "31");
+    loop(20);
+    check(ReefAngel.Relay.RelayMaskOn == on && ReefAngel.Network.IsMQTTConnected(), "unknown commands were ignored");
+}
+
+// Memory writes back to back: each waits for its MBOK before the next goes out
+void benchRoundTrip() {
+    unsigned long worst = 0;
+    unsigned long total = 0;
+    int answered = 0;
+    uint64_t start = HostNanos();
+    for (int r = 0; r < ROUNDS; r++) {
+        char payload[20], ack[12];
+        sprintf(payload, "mb:%d:%d", 840 + r % 8, r & 255);
+        sprintf(ack, "MBOK:%d", 840 + r % 8);
+        size_t since = broker.published.size();
+        broker.publish(topic("in"), payload);
+        unsigned long waited = 0;
+        while (!published(ack, since) && waited < 1000) {
+            loop(10);
+            waited += 10;
+        }
+        if (published(ack, since)) answered++;
+        total += waited;
+        if (waited > worst) worst = waited;
+    }
+    uint64_t elapsed = HostNanos() - start;
+    report("mb: round trips", ROUNDS, elapsed);
+    printf("%-24s %8d answered  %.1f ms average  %lu ms worst\n", "latency", answered, (double)total / ROUNDS, worst);
+    check(answered == ROUNDS, "every memory write was acknowledged");
+    // loop() takes one packet per pass, so a command can queue behind the PUBACKs of a
+    // full MQTT_QUEUE_SIZE batch of parameter publishes
+    check(total <= 2 * 10 * ROUNDS, "a memory write was acknowledged within two passes on average");
+    check(worst <= (MQTT_QUEUE_SIZE + 1) * 10, "no acknowledgement waited behind more than a queue of PUBACKs");
+
+    // The callbacks alone, without the network
+    const char *commands[] = { "r:31", "r:32", "po:0:60", "po:0:255", "mb:850:1" };
+    start = HostNanos();
+    for (int r = 0; r < ROUNDS; r++)
+        for (unsigned int i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+            MQTTSubCallback((char *)"", (byte *)commands[i], strlen(commands[i]));
+    report("MQTTSubCallback()", ROUNDS * 5, HostNanos() - start);
+    char route[sizeof(CLOUD_USERNAME) + 8];
+    sprintf(route, "%s/in/r", CLOUD_USERNAME);
+    start = HostNanos();
+    for (int r = 0; r < ROUNDS; r++) {
+        MQTTTopicCallback(route, (byte *)"31", 2);
+        MQTTTopicCallback(route, (byte *)"32", 2);
+    }
+    report("MQTTTopicCallback()", ROUNDS * 2, HostNanos() - start);
+}
+
+// Everything the controller reports, after all:0 invalidates it
+void benchPublish() {
+    loop(2000);
+    size_t since = broker.published.size();
+    uint64_t start = HostNanos();
+    broker.publish(topic("in"), "all:0");
+    unsigned long waited = 0, quiet = 0;
+    while (quiet < 2000) {
+        size_t before = broker.published.size();
+        loop(10);
+        waited += 10;
+        quiet = broker.published.size() == before ? quiet + 10 : 0;
+    }
+    uint64_t elapsed = HostNanos() - start;
+    unsigned long count = broker.published.size() - since;
+    unsigned long bytes = 0;
+    for (size_t i = since; i < broker.published.size(); i++) bytes += broker.published[i].size();
+    report("all:0 publishes", count, elapsed);
+    printf("%-24s %8lu in %5lu ms  %lu payload bytes\n", "parameters", count, waited - quiet, bytes);
+    boolean t1 = false, pwm = false;
+    for (size_t i = since; i < broker.published.size(); i++) {
+        if (broker.published[i].compare(0, 3, "T1:") == 0) t1 = true;
+        if (broker.published[i].compare(0, 6, "PWMDO:") == 0) pwm = true;
+    }
+    check(t1 && pwm, "all:0 published the parameters again");
+}
+
+// Replays data/cloud_replay.txt, see the format there
+void testReplay() {
+    FILE *f = fopen(REPLAY, "r");
+    check(f != NULL, "the replay file opened");
+    if (!f) return;
+    char line[128];
+    int commands = 0, line_no = 0;
+    size_t since = broker.published.size();
+    uint64_t start = HostNanos();
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = 0;
+        char what[16], arg[32];
+        unsigned long wait;
+        unsigned int a, b;
+        boolean ok = true;
+        if (line[0] == '#' || line[0] == 0) continue;
+        if (sscanf(line, "= %15s %31s", what, arg) == 2) {
+            loop(20);
+            if (strcmp(what, "relay") == 0 && sscanf(line, "= relay %x %x", &a, &b) == 2)
+                ok = ReefAngel.Relay.RelayMaskOn == a && ReefAngel.Relay.RelayMaskOff == b;
+            else if (strcmp(what, "mem") == 0 && sscanf(line, "= mem %u %u", &a, &b) == 2)
+                ok = InternalMemory.read(a) == b;
+            else if (strcmp(what, "daylight") == 0)
+                ok = ReefAngel.PWM.GetDaylightOverrideValue() == atoi(arg);
+            else if (strcmp(what, "actinic") == 0)
+                ok = ReefAngel.PWM.GetActinicOverrideValue() == atoi(arg);
+            else if (strcmp(what, "out") == 0) {
+                // parameters go out once a second, MQTT_QUEUE_SIZE at a time
+                for (int i = 0; i < 1000 && !published(arg, since); i++) loop(10);
+                ok = published(arg, since);
+                since = broker.published.size();
+            }
+            else ok = false;
+        }
+        else if (sscanf(line, "%lu %15s %31s", &wait, what, arg) == 3) {
+            loop(wait);
+            broker.publish(topic(what), arg);
+            commands++;
+        }
+        else ok = false;
+        if (!ok) printf("%s:%d: %s\n", REPLAY, line_no, line);
+        check(ok, "the controller matched the replay");
+    }
+    fclose(f);
+    report("replayed commands", commands, HostNanos() - start);
+}
+
+int main() {
+    start();
+    testConnect();
+    testCommands();
+    benchRoundTrip();
+    benchPublish();
+    testReplay();
+    return finish();
+}
@@ -0,0 +1,87 @@
+// MQTTLookup() against the strcmp() chain it replaced, over a command mix like the
+// cloud's: mostly relay overrides, port overrides and memory writes. Compares are the
+// strcmp_P()/strcmp() calls per lookup; time is host CPU time and only useful
+// relative to the other row.
+#include "harness.h"
+
+typedef struct {
+    const char *name;
+    byte type;
+} Command;
+
+// Every command, in the order the old if/else chain tested them
+const Command commands[] = {
+    {"all",MQTT_REQUESTALL}, {"t",MQTT_T}, {"r",MQTT_R}, {"mf",MQTT_MODE_FEEDING}, {"mw",MQTT_MODE_WATERCHANGE},
+    {"mt",MQTT_ALARM_ATO}, {"mo",MQTT_ALARM_OVERHEAT}, {"ml",MQTT_ALARM_LEAK}, {"l",MQTT_LIGHTS},
+    {"boot",MQTT_REBOOT}, {"sal",MQTT_SALINITY}, {"salc",MQTT_CALIBRATION}, {"orp",MQTT_ORP},
+    {"orpc",MQTT_CALIBRATION}, {"phe",MQTT_PHEXP}, {"phec",MQTT_CALIBRATION}, {"cexp",MQTT_CUSTOM_EXP},
+    {"cexpc",MQTT_CUSTOM_CALIBRATION}, {"io",MQTT_IO}, {"wl",MQTT_WL}, {"wlc",MQTT_CALIBRATION},
+    {"leak",MQTT_LEAK}, {"par",MQTT_PAR}, {"hum",MQTT_HUM}, {"po",MQTT_OVERRIDE}, {"cvar",MQTT_CVAR},
+    {"mb",MQTT_MEM_BYTE}, {"mi",MQTT_MEM_INT}, {"date",MQTT_DATE}, {"v",MQTT_VERSION}, {"mr",MQTT_MEM_RAW},
+    {"avs",MQTT_ALEXA}, {"ozo",MQTT_OZONE}, {"co2",MQTT_CO2}, {"co2hum",MQTT_CO2HUM}, {"calph",MQTT_CALPH},
+    {"calorp",MQTT_CALORP}, {"calsal",MQTT_CAlSAL}, {"calphe",MQTT_CALPHE}, {"calwl",MQTT_CALWL},
+    {"calwl1",MQTT_CALWL1}, {"calwl2",MQTT_CALWL2}, {"calwl3",MQTT_CALWL3}, {"calwl4",MQTT_CALWL4},
+    {"calcus1",MQTT_CALCUS1}, {"calcus2",MQTT_CALCUS2}, {"calcus3",MQTT_CALCUS3}, {"calcus4",MQTT_CALCUS4},
+    {"calcus5",MQTT_CALCUS5}, {"calcus6",MQTT_CALCUS6}, {"calcus7",MQTT_CALCUS7}, {"calcus8",MQTT_CALCUS8},
+    {"prof",MQTT_PROFILER}, {"bin",MQTT_BINARY}
+};
+#define COMMANDS (sizeof(commands) / sizeof(commands[0]))
+
+// One minute of a busy dashboard
+const char *mix[] = {
+    "r", "r", "po", "r", "mb", "r", "po", "all", "r", "mi", "po", "r", "mb", "cvar", "r", "po",
+    "mf", "r", "mb", "l", "r", "po", "date", "r", "mw", "cvar", "r", "po", "calwl3", "r", "mb", "xyz"
+};
+#define MIX (sizeof(mix) / sizeof(mix[0]))
+#define ROUNDS 20000
+
+unsigned long chainCompares;
+
+byte chainLookup(const char *token) {
+    for (unsigned int i = 0; i < COMMANDS; i++) {
+        chainCompares++;
+        if (strcmp(commands[i].name, token) == 0) return commands[i].type;
+    }
+    return MQTT_NONE;
+}
+
+unsigned long worst;
+
+byte countedLookup(const char *token) {
+    unsigned long compares = HostFlashCompares();
+    byte type = MQTTLookup(token);
+    if (HostFlashCompares() - compares > worst) worst = HostFlashCompares() - compares;
+    return type;
+}
+
+int main() {
+    for (unsigned int i = 0; i < COMMANDS; i++)
+        check(countedLookup(commands[i].name) == commands[i].type, commands[i].name);
+    const char *unknown[] = { "", "a", "calcus9", "zz", "rr", "calwl12345" };
+    for (unsigned int i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++)
+        check(countedLookup(unknown[i]) == MQTT_NONE, "an unknown command was not matched");
+    // A binary search over the table never needs more than log2(size) + 1 compares
+    unsigned long bound = 0;
+    while ((1UL << bound) <= COMMANDS) bound++;
+    check(worst <= bound, "no lookup took more than log2(commands) + 1 compares");
+
+    volatile byte sink = 0;
+    unsigned long compares = HostFlashCompares();
+    uint64_t start = HostNanos();
+    for (int r = 0; r < ROUNDS; r++)
+        for (unsigned int i = 0; i < MIX; i++) sink += MQTTLookup(mix[i]);
+    uint64_t table = HostNanos() - start;
+    compares = HostFlashCompares() - compares;
+
+    start = HostNanos();
+    for (int r = 0; r < ROUNDS; r++)
+        for (unsigned int i = 0; i < MIX; i++) sink += chainLookup(mix[i]);
+    uint64_t chain = HostNanos() - start;
+
+    unsigned long lookups = (unsigned long)ROUNDS * MIX;
+    printf("%-24s %8lu in %7lu us  %8.3f us each  %.2f compares each\n", "MQTTLookup()", lookups,
+           (unsigned long)(table / 1000), table / 1000.0 / lookups, (double)compares / lookups);
+    printf("%-24s %8lu in %7lu us  %8.3f us each  %.2f compares each\n", "strcmp() chain", lookups,
+           (unsigned long)(chain / 1000), chain / 1000.0 / lookups, (double)chainCompares / lookups);
+    return finish();
+}
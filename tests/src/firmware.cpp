@@ -0,0 +1,99 @@
+// The Star's firmware download from the web wizard server, interrupted and resumed
+// with Range requests on the emulated W5100, into the in-memory SD card
+#include "harness.h"
+
+#define IMAGE_SIZE 4000
+
+uint8_t image[IMAGE_SIZE];
+
+// Serves the image, or the part a Range request asks for, and hangs up where
+// cuts says for that request as a flaky connection would
+class FirmwareServer : public HostPeer {
+public:
+    FirmwareServer() : HostPeer(3000), requests(0) {}
+    int requests;
+    unsigned long cuts[4];      // hang up once the body reaches this offset
+    unsigned long rangeStart;
+    std::string request;
+    std::string pending;
+    void connected() {
+        request.clear();
+        pending.clear();
+    }
+    void receive(const uint8_t *data, size_t len) {
+        request.append((const char *)data, len);
+        if (request.find("\r\n\r\n") == std::string::npos) return;
+        requests++;
+        rangeStart = 0;
+        size_t r = request.find("Range: bytes=");
+        if (r != std::string::npos) rangeStart = strtoul(request.c_str() + r + 13, NULL, 10);
+        char header[160];
+        if (rangeStart)
+            sprintf(header, "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %lu-%d/%d\r\n"
+                    "Content-Length: %lu\r\n\r\n", rangeStart, IMAGE_SIZE - 1, IMAGE_SIZE,
+                    IMAGE_SIZE - rangeStart);
+        else
+            sprintf(header, "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n", IMAGE_SIZE);
+        pending = header;
+        pending.append((const char *)image + rangeStart, cuts[requests - 1] - rangeStart);
+        request.clear();
+    }
+    // Hands the controller as much as its receive buffer takes, then hangs up
+    void pump() {
+        if (socket < 0 || pending.empty()) return;
+        size_t n = HostEthernet.send(socket, (const uint8_t *)pending.data(), pending.size());
+        pending.erase(0, n);
+        if (pending.empty()) close();
+    }
+};
+
+FirmwareServer webwizard;
+
+// Refresh() passes while the server keeps feeding the controller, until it has
+// been asked for the image requests times
+void download(int requests) {
+    for (int i = 0; i < 1000 && webwizard.requests < requests; i++) {
+        webwizard.pump();
+        run(10);
+    }
+}
+
+std::string sdFile() {
+    std::string data;
+    File f = SD.open("FIRMWARE.BIN", FILE_READ);
+    uint8_t b[64];
+    int n;
+    while (f && (n = f.read(b, sizeof(b))) > 0) data.append((const char *)b, n);
+    f.close();
+    return data;
+}
+
+// Each resume reads back only what arrived since the last one
+void testResume() {
+    for (int i = 0; i < IMAGE_SIZE; i++) image[i] = (i * 7 + i / 251) & 0xFF;
+    for (int i = 0; i < 1000 && !ReefAngel.Network.FoundIP; i++) run(10);
+    check(ReefAngel.Network.FoundIP, "the network came up");
+
+    webwizard.cuts[0] = 1500;
+    webwizard.cuts[1] = 2500;
+    webwizard.cuts[2] = 3000;
+    ReefAngel.Network.ForceCheckFirmware();
+    unsigned long read = SD.bytesRead;
+    download(2);
+    check(webwizard.requests == 2, "the download resumed after the first hang-up");
+    check(webwizard.rangeStart == 1500, "the resume asked for the rest");
+    check(SD.bytesRead - read == 1500, "the first resume read the 1500 bytes on SD back");
+
+    read = SD.bytesRead;
+    download(3);
+    check(webwizard.requests == 3, "the download resumed after the second hang-up");
+    check(webwizard.rangeStart == 2500, "the second resume asked for the rest");
+    check(SD.bytesRead - read == 1000, "the second resume only read back the new 1000 bytes");
+    check(sdFile() == std::string((const char *)image, 2500), "FIRMWARE.BIN holds the first 2500 bytes");
+}
+
+int main() {
+    start();
+    testResume();
+    return finish();
+}
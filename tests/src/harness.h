@@ -0,0 +1,130 @@
+// Shared by the checks: the controller with an RTC, the relay box and one expansion
+// relay box answering on I2C, started on the virtual clock, and on the Star a stand-in
+// for the cloud's MQTT broker
+#ifndef harness_h
+#define harness_h
+
+#include <ReefAngel_Features.h>
+#include <Globals.h>
+#include <ReefAngel.h>
+#include <Host.h>
+#ifdef ETH_WIZ5100
+#include <HostW5100.h>
+#endif  // ETH_WIZ5100
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+HostI2CDevice rtc(I2CClock);
+HostI2CDevice relaybox(I2CExpander1);
+HostI2CDevice expansionbox(I2CExpModule);
+#ifdef SALINITYEXPANSION
+HostI2CDevice salinitybox(I2CSalinity);
+#endif  // SALINITYEXPANSION
+
+#ifdef ETH_WIZ5100
+// Answers CONNECT, SUBSCRIBE and QoS 1 PUBLISH like the cloud broker, keeps what the
+// controller published and delivers commands to it
+class MQTTBroker : public HostPeer {
+public:
+    MQTTBroker() : HostPeer(MQTTPORT) {}
+    std::string pending;                // bytes of a packet that is not complete yet
+    std::string subscribed;             // topic filter of the last SUBSCRIBE
+    std::vector<std::string> published; // payloads the controller published
+    void receive(const uint8_t *data, size_t len) {
+        pending.append((const char *)data, len);
+        size_t pos = 0;
+        while (pos + 2 <= pending.size()) {
+            const uint8_t *packet = (const uint8_t *)pending.data() + pos;
+            uint8_t header = packet[0];
+            uint32_t length = 0;
+            uint32_t multiplier = 1;
+            size_t p = 1;
+            while (pos + p < pending.size()) {
+                length += (packet[p] & 127) * multiplier;
+                multiplier *= 128;
+                if (!(packet[p++] & 128)) break;
+            }
+            if (pos + p + length > pending.size()) break;
+            const uint8_t *body = packet + p;
+            if ((header & 0xF0) == 0x10) {
+                const uint8_t connack[] = { 0x20, 2, 0, 0 };
+                send(connack, sizeof(connack));
+            }
+            else if ((header & 0xF0) == 0x80) {
+                uint16_t tlen = (body[2] << 8) | body[3];
+                subscribed.assign((const char *)body + 4, tlen);
+                const uint8_t suback[] = { 0x90, 3, body[0], body[1], 0 };
+                send(suback, sizeof(suback));
+            }
+            else if ((header & 0xF0) == 0x30) {
+                uint16_t tlen = (body[0] << 8) | body[1];
+                size_t id = header & 0x06 ? 2 : 0;
+                published.push_back(std::string((const char *)body + 2 + tlen + id, length - 2 - tlen - id));
+                if (id) {
+                    const uint8_t puback[] = { 0x40, 2, body[2 + tlen], body[3 + tlen] };
+                    send(puback, sizeof(puback));
+                }
+            }
+            pos += p + length;
+        }
+        pending.erase(0, pos);
+    }
+    // A QoS 0 PUBLISH to the controller
+    void publish(const std::string &topic, const std::string &payload) {
+        std::string packet(1, (char)0x30);
+        size_t length = 2 + topic.size() + payload.size();
+        do {
+            packet += (char)((length & 127) | (length > 127 ? 128 : 0));
+            length >>= 7;
+        } while (length);
+        packet += (char)(topic.size() >> 8);
+        packet += (char)(topic.size() & 255);
+        packet += topic + payload;
+        send((const uint8_t *)packet.data(), packet.size());
+    }
+};
+#endif  // ETH_WIZ5100
+
+int failures = 0;
+
+void check(boolean ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+void report(const char* what, unsigned long count, uint64_t nanos) {
+    printf("%-24s %8lu in %7lu us  %8.2f us each\n", what, count, (unsigned long)(nanos / 1000),
+           nanos / 1000.0 / count);
+}
+
+// Fri 2026-10-16 12:00:00 in DS1307 registers, then Init() at millis() 1000
+void start() {
+    const uint8_t clock[7] = { 0x00, 0x00, 0x12, 0x06, 0x16, 0x10, 0x26 };
+    memcpy(rtc.reply, clock, sizeof(clock));
+    rtc.replyLength = sizeof(clock);
+    InternalMemory.IMCheck_write(0xCF06A31E);
+    HostSetMillis(1000);
+    ReefAngel.Init();
+}
+
+// Refresh() passes on 10 ms ticks
+void run(unsigned long ms) {
+    for (unsigned long t = 0; t < ms; t += 10) {
+        HostAdvanceMillis(10);
+        ReefAngel.Refresh();
+    }
+}
+
+int finish() {
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,147 @@
+// The Star's HTTP server on the emulated W5100, next to the cloud and portal
+// connections that share its four sockets
+#include "harness.h"
+
+// The firmware server accepts the connection and then says nothing
+class SilentServer : public HostPeer {
+public:
+    SilentServer() : HostPeer(3000) {}
+};
+
+MQTTBroker broker;
+SilentServer webwizard;
+
+// Opens a connection to the controller and sends request in one piece
+int request(const char *text) {
+    int s = HostEthernet.connect(STARPORT);
+    if (s >= 0) HostEthernet.send(s, text);
+    return s;
+}
+
+boolean startsWith(const std::string &s, const char *prefix) {
+    return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+void testNetworkUp() {
+    for (int i = 0; i < 1000 && !ReefAngel.Network.FoundIP; i++) run(10);
+    check(ReefAngel.Network.FoundIP, "the network came up");
+    HostAdvanceMillis(6000);
+    ReefAngel.Network.Cloud();
+    check(ReefAngel.Network.IsMQTTConnected(), "MQTT connected");
+}
+
+// Status responses leave in WIFI_OUTPUT_BUFFER blocks, not one socket send per byte
+// as print() and PROGMEMprint() produce them
+void testResponseWrites() {
+    const char *paths[] = { "/", "/r", "/sa", "/sr", "/json", "/sd" };
+    for (unsigned int i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        std::string text = std::string("GET ") + paths[i] + " HTTP/1.1\r\nConnection: close\r\n\r\n";
+        int s = request(text.c_str());
+        unsigned long sends = HostEthernet.sends[s];
+        run(20);
+        sends = HostEthernet.sends[s] - sends;
+        std::string reply = HostEthernet.take(s);
+        unsigned long blocks = (reply.size() + WIFI_OUTPUT_BUFFER - 1) / WIFI_OUTPUT_BUFFER;
+        printf("GET %-20s %8lu bytes in %4lu writes, %4lu unbuffered\n", paths[i], (unsigned long)reply.size(),
+               sends, (unsigned long)reply.size());
+        check(startsWith(reply, "HTTP/1.1 200"), "a status request was answered");
+        check(sends <= blocks + 1, "a response took no more writes than its WIFI_OUTPUT_BUFFER blocks");
+    }
+}
+
+// A request is read from the W5100 in blocks: RX size reads and SPI frames grow with
+// the blocks, not with every byte of the request
+void testRequestReads() {
+    std::string text = "GET /r HTTP/1.1\r\nConnection: close\r\n";
+    while (text.size() < 1000) text += "X-Padding: 0123456789abcdefghijklmnopqrstuvwxyz\r\n";
+    text += "\r\n";
+    int s = request(text.c_str());
+    unsigned long reads = HostEthernet.sizeReads[s];
+    unsigned long frames = HostEthernet.frames;
+    std::string reply;
+    for (int i = 0; i < 100 && reply.empty(); i++) {
+        run(10);
+        reply = HostEthernet.take(s);
+    }
+    run(20);
+    reply += HostEthernet.take(s);
+    reads = HostEthernet.sizeReads[s] - reads;
+    frames = HostEthernet.frames - frames;
+    printf("%-24s %8lu bytes  %5lu RX size reads  %6lu SPI frames for %lu bytes out\n", "request", (unsigned long)text.size(),
+           reads, frames, (unsigned long)reply.size());
+    check(startsWith(reply, "HTTP/1.1 200"), "the padded request was answered");
+    // Read a byte at a time the same request takes two RX size reads and about twelve
+    // SPI frames per byte
+    check(reads <= 2 * ((text.size() + 31) / 32) + 4, "the RX size was read about twice per 32 byte block");
+    check(frames < 2 * (text.size() + reply.size()), "the SPI frames stayed within twice the bytes moved");
+}
+
+// A client trickling its headers a byte at a time gets REQUEST_TIMEOUT from its
+// first byte, then whatever arrived is answered and the next client is served
+void testSlowClient() {
+    int a = request("GET /r HTTP/1.1\r\nX-Slow: ");
+    check(a >= 0, "the slow client connected");
+    run(10);
+    int b = request("GET /r HTTP/1.1\r\nConnection: close\r\n\r\n");
+    check(b >= 0, "a second client connected behind it");
+    std::string reply;
+    unsigned long waited = 0;
+    while (waited < 3000 && reply.empty()) {
+        if (HostEthernet.status(a) == 0x17) HostEthernet.send(a, "x");
+        run(50);
+        waited += 50;
+        reply = HostEthernet.take(b);
+    }
+    check(startsWith(reply, "HTTP/1.1 200"), "the second client was served");
+    check(waited <= REQUEST_TIMEOUT + 100, "the trickling client held the server no longer than REQUEST_TIMEOUT");
+    check(HostEthernet.status(a) != 0x17, "the trickling client was closed");
+    run(20);
+}
+
+// /events keeps its socket for good, so it is refused while that would leave
+// none free for the portal, DHCP and the next client
+void testEventsSocket() {
+    ReefAngel.Network.ForceCheckFirmware();
+    check(webwizard.socket >= 0, "the firmware check holds a socket");
+
+    int a = request("GET /events HTTP/1.1\r\n\r\n");
+    check(a >= 0, "the listener took a client next to MQTT and the firmware check");
+    run(20);
+    std::string reply = HostEthernet.take(a);
+    check(startsWith(reply, "HTTP/1.1 503"), "/events was refused with every socket in use");
+    check(HostEthernet.status(a) == 0, "the refused /events connection was closed");
+
+    // The firmware server hangs up and its socket comes back
+    webwizard.close();
+    run(20);
+    check(webwizard.socket < 0, "the firmware check let go of its socket");
+
+    int b = request("GET /events HTTP/1.1\r\n\r\n");
+    run(20);
+    reply = HostEthernet.take(b);
+    check(startsWith(reply, "HTTP/1.1 200") && reply.find("text/event-stream") != std::string::npos,
+          "/events was accepted with a socket to spare");
+    check(HostEthernet.status(b) == 0x17, "the /events connection stayed open");
+
+    int c = request("GET /r HTTP/1.1\r\nConnection: close\r\n\r\n");
+    check(c >= 0, "a client still got in next to /events");
+    run(20);
+    check(startsWith(HostEthernet.take(c), "HTTP/1.1 200"), "a status request was served next to /events");
+    run(20);
+
+    // A second subscriber replaces the first, which needs no extra socket
+    int d = request("GET /events HTTP/1.1\r\n\r\n");
+    run(20);
+    check(startsWith(HostEthernet.take(d), "HTTP/1.1 200"), "a new /events subscriber replaced the old one");
+    check(HostEthernet.status(b) == 0, "the old /events connection was closed");
+}
+
+int main() {
+    start();
+    testNetworkUp();
+    testResponseWrites();
+    testRequestReads();
+    testSlowClient();
+    testEventsSocket();
+    return finish();
+}
@@ -0,0 +1,72 @@
+// Refresh() on the host, for the board profile this was built for. The controller
+// runs against a virtual clock that moves 10 ms per pass. Time is host CPU time and
+// only useful relative to other runs; the hardware counts per pass are what the board
+// has to move.
+#include "harness.h"
+
+#define PASSES 5000
+#define PASS_MS 10
+
+int main() {
+    start();
+
+    unsigned long i2c = HostI2CTransmissions();
+    unsigned long analog = HostAnalogReads();
+    unsigned long spi = SPIClass::transfers;
+    unsigned long wdt = HostWatchdogResets();
+#ifdef SALINITYEXPANSION
+    unsigned long salinity = salinitybox.transmissions;
+#endif  // SALINITYEXPANSION
+    uint64_t total = 0;
+    uint64_t worst = 0;
+    uint64_t best = ~0ULL;
+    for (int i = 0; i < PASSES; i++) {
+        HostAdvanceMillis(PASS_MS);
+        uint64_t start = HostNanos();
+        ReefAngel.Refresh();
+        uint64_t elapsed = HostNanos() - start;
+        total += elapsed;
+        if (elapsed > worst) worst = elapsed;
+        if (elapsed < best) best = elapsed;
+    }
+    printf("%-24s %8d in %7lu us  %8.2f us each  min %.2f us  max %.2f us\n", "Refresh()", PASSES,
+           (unsigned long)(total / 1000), total / 1000.0 / PASSES, best / 1000.0, worst / 1000.0);
+    printf("%-24s %.2f I2C transmissions  %.2f analogRead()  %.1f SPI bytes  %.2f wdt_reset()\n",
+           "per pass", (double)(HostI2CTransmissions() - i2c) / PASSES,
+           (double)(HostAnalogReads() - analog) / PASSES, (double)(SPIClass::transfers - spi) / PASSES,
+           (double)(HostWatchdogResets() - wdt) / PASSES);
+
+#ifdef SALINITYEXPANSION
+    // The scheduler reads the expansions once every SAMPLE_PERIOD, not on every pass
+    unsigned long reads = salinitybox.transmissions - salinity;
+    check(reads <= PASSES * PASS_MS / SAMPLE_PERIOD && reads >= PASSES * PASS_MS / SAMPLE_PERIOD * 9 / 10,
+          "the salinity expansion was read once every SAMPLE_PERIOD");
+#endif  // SALINITYEXPANSION
+#ifdef RelayExp
+    // Box 2 isn't there and NACKs, its new state is retried with the periodic refresh only
+    i2c = HostI2CTransmissions();
+    for (int i = 0; i < 100; i++) {
+        HostAdvanceMillis(PASS_MS);
+        ReefAngel.Refresh();
+    }
+    unsigned long idle = HostI2CTransmissions() - i2c;
+    ReefAngel.Relay.On(21);
+    i2c = HostI2CTransmissions();
+    for (int i = 0; i < 100; i++) {
+        HostAdvanceMillis(PASS_MS);
+        ReefAngel.Refresh();
+    }
+    check(HostI2CTransmissions() - i2c <= idle + 2, "a missing relay box was not rewritten on every pass");
+#endif  // RelayExp
+
+    check(now() > 1760000000UL, "the clock was read from the RTC");
+    check(relaybox.transmissions > 0, "the relay box was written");
+#ifdef RelayExp
+    check(expansionbox.transmissions > 0, "the expansion relay box was written");
+#endif  // RelayExp
+#ifdef ETH_WIZ5100
+    check(HostEthernet.leases == 1, "DHCP handed out one lease");
+    check(ReefAngel.Network.FoundIP, "the network came up");
+#endif  // ETH_WIZ5100
+    return finish();
+}
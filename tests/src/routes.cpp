@@ -0,0 +1,151 @@
+// RA_Wifi::PushBuffer() request line classification: the known routes, then random
+// request lines and mutations of real ones checked against a plain prefix match over
+// the same routes, then the cost per request line and per byte fed. Time is host CPU
+// time and only useful relative to other runs.
+#include "harness.h"
+#include <stdlib.h>
+
+// The route table in RA_Wifi.cpp, as PushBuffer() is expected to apply it
+typedef struct {
+    const char *path;
+    byte reqtype;
+} Route;
+
+const Route routes[] = {
+    {"GET / ",REQ_ROOT}, {"GET /boot",REQ_REBOOT}, {"GET /bp",256-REQ_BTN_PRESS}, {"GET /cal",256-REQ_CALIBRATION},
+#ifdef CUSTOM_VARIABLES
+    {"GET /cvar",256-REQ_M_CVAR},
+#endif  // CUSTOM_VARIABLES
+    {"GET /d",256-REQ_DATE},
+#ifdef ETH_WIZ5100
+    {"GET /events",REQ_EVENTS},
+#endif  // ETH_WIZ5100
+    {"GET /favicon.ico",REQ_FAVICON}, {"GET /json",REQ_JSON}, {"GET /l0",256-REQ_LIGHTSOFF},
+    {"GET /l1",256-REQ_LIGHTSON}, {"GET /mb",256-REQ_M_BYTE}, {"GET /mf",256-REQ_FEEDING}, {"GET /mi",256-REQ_M_INT},
+    {"GET /ml",256-REQ_ALARM_LEAK}, {"GET /mo",256-REQ_ALARM_OVERHEAT}, {"GET /mr",256-REQ_M_RAW},
+    {"GET /mt",256-REQ_ALARM_ATO}, {"GET /mw",256-REQ_WATER}, {"GET /po",256-REQ_OVERRIDE}, {"GET /r",256-REQ_RELAY},
+    {"GET /sa",256-REQ_RA_STATUS}, {"GET /sb",REQ_BINARY}, {"GET /sd",REQ_SCHEMA}, {"GET /sr",256-REQ_R_STATUS},
+    {"GET /v",256-REQ_VERSION}, {"GET /wifi",REQ_WIFI}, {"HTTP/1.",256-REQ_HTTP},
+#ifdef CLOUD_WIFI
+    {"cloud:",256-REQ_CLOUD},
+#endif  // CLOUD_WIFI
+};
+#define ROUTES (sizeof(routes) / sizeof(routes[0]))
+
+// Exposes what PushBuffer() decided
+class RouteProbe : public RA_Wifi {
+public:
+    // Feeds bytes until the line is classified, returns the request type (0 if none)
+    byte classify(const std::string &text) {
+        reqtype = 0;
+        m_pushbackindex = 0;
+        for (size_t i = 0; i < text.size() && !reqtype; i++) {
+            PushBuffer(text[i]);
+            fed++;
+            if (m_pushbackindex >= sizeof(m_pushback)) overrun = true;
+        }
+        return reqtype;
+    }
+    int location() { return weboption2; }
+    int value() { return weboption; }
+    // Feeds the parameters of a route up to the space after them
+    void finish(const char *rest) {
+        while (*rest && reqtype > 128) PushBuffer(*rest++);
+    }
+    byte type() { return reqtype; }
+    // Classifying a request line never answers it
+    size_t write(uint8_t c) { return 1; }
+    boolean overrun;
+    unsigned long fed;
+};
+
+// Line by line: the route that starts a line wins, "GET /" with no route is unknown,
+// any other line is skipped
+byte expected(const std::string &text) {
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        std::string line = text.substr(start, end == std::string::npos ? std::string::npos : end - start + 1);
+        for (unsigned int r = 0; r < ROUTES; r++)
+            if (line.compare(0, strlen(routes[r].path), routes[r].path) == 0) return routes[r].reqtype;
+        if (line.size() > 5 && line.compare(0, 5, "GET /") == 0) return REQ_UNKNOWN;
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    return 0;
+}
+
+RouteProbe probe;
+
+void testRoutes() {
+    for (unsigned int r = 0; r < ROUTES; r++) {
+        std::string line = std::string(routes[r].path) + "12 HTTP/1.1\r\n";
+        check(probe.classify(line) == routes[r].reqtype, routes[r].path);
+    }
+    check(probe.classify("GET /nothere HTTP/1.1\r\n") == REQ_UNKNOWN, "an unknown path is reported");
+    check(probe.classify("POST / HTTP/1.1\r\n") == 0, "a line that isn't a route is skipped");
+    check(probe.classify("Host: x\r\nGET /r HTTP/1.1\r\n") == 256 - REQ_RELAY, "a route on the next line is found");
+    check(probe.classify("GET /mz\nGET /r HTTP/1.1\r\n") == REQ_UNKNOWN, "an unknown path ends the request");
+
+    probe.classify("GET /mb");
+    probe.finish("800,5 HTTP/1.1\r\n");
+    check(probe.type() == REQ_M_BYTE && probe.location() == 800 && probe.value() == 5,
+          "the parameters of /mb were read up to the space");
+}
+
+const char *samples[] = {
+    "GET / HTTP/1.1\r\n", "GET /r HTTP/1.1\r\n", "GET /sa HTTP/1.1\r\n", "GET /mb800 HTTP/1.1\r\n",
+    "GET /mi850,300 HTTP/1.1\r\n", "GET /po3,50 HTTP/1.1\r\n", "GET /json HTTP/1.1\r\n", "GET /d1200,1,2 HTTP/1.1\r\n",
+    "HTTP/1.1 200 OK\r\n", "GET /favicon.ico HTTP/1.1\r\n", "GET /events HTTP/1.1\r\n", "cloud:r:3 ",
+};
+#define SAMPLES (sizeof(samples) / sizeof(samples[0]))
+
+// Mutated real requests and random bytes, every one classified like the prefix match
+void testFuzz() {
+    const char alphabet[] = "GET /HTP1.\r\n cloud:abdefijlmoprsvwx0123456789,-";
+    srand(2026);
+    int mismatches = 0;
+    for (int n = 0; n < 200000; n++) {
+        std::string text;
+        if (n % 4 == 0) {
+            int len = rand() % 24;
+            for (int i = 0; i < len; i++)
+                text += rand() % 3 ? alphabet[rand() % (sizeof(alphabet) - 1)] : (char)(rand() % 256);
+        }
+        else {
+            text = samples[rand() % SAMPLES];
+            for (int m = rand() % 3 + 1; m > 0; m--) {
+                size_t at = rand() % (text.size() + 1);
+                char c = alphabet[rand() % (sizeof(alphabet) - 1)];
+                switch (rand() % 3) {
+                    case 0: text.insert(at, 1, c); break;
+                    case 1: if (at < text.size()) text.erase(at, 1); break;
+                    case 2: if (at < text.size()) text[at] = c; break;
+                }
+            }
+        }
+        if (probe.classify(text) != expected(text) && mismatches++ < 5)
+            printf("classified 0x%02x, expected 0x%02x: \"%s\"\n", probe.type(), expected(text), text.c_str());
+    }
+    check(mismatches == 0, "every fuzzed request was classified like the prefix match");
+    check(!probe.overrun, "the line position never ran past m_pushback");
+}
+
+void bench() {
+    unsigned long bytes = probe.fed;
+    uint64_t start = HostNanos();
+    for (int r = 0; r < 20000; r++)
+        for (unsigned int i = 0; i < SAMPLES; i++) probe.classify(samples[i]);
+    uint64_t elapsed = HostNanos() - start;
+    bytes = probe.fed - bytes;
+    report("PushBuffer() requests", 20000 * SAMPLES, elapsed);
+    printf("%-24s %8lu in %7lu us  %8.4f us each\n", "PushBuffer() bytes", bytes,
+           (unsigned long)(elapsed / 1000), elapsed / 1000.0 / bytes);
+}
+
+int main() {
+    testRoutes();
+    testFuzz();
+    bench();
+    return finish();
+}
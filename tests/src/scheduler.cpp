@@ -0,0 +1,57 @@
+// Jitter of the periodic tasks ReefAngel.Scheduler runs from Refresh(): three probe
+// tasks are added next to the controller's own and every run is stamped with the
+// virtual clock. Lateness is how far a run came after its nominal time, in ms; the
+// Refresh() times are host CPU time and only useful relative to other runs.
+#include "harness.h"
+#include <algorithm>
+#include <vector>
+
+#define PROBES 3
+#define PROBE_INTERVAL 100
+#define PASSES 2000
+#define PASS_MS 10
+
+unsigned long started;
+unsigned long runs[PROBES];
+unsigned long worstLate;
+unsigned long passRuns;
+
+template <int N> void probe() {
+    runs[N]++;
+    unsigned long late = millis() - (started + runs[N] * PROBE_INTERVAL);
+    if (late > worstLate) worstLate = late;
+    passRuns++;
+}
+
+int main() {
+    start();
+    TaskCallback probes[PROBES] = { probe<0>, probe<1>, probe<2> };
+    started = millis();
+    for (int i = 0; i < PROBES; i++)
+        check(ReefAngel.Scheduler.Add(probes[i], PROBE_INTERVAL) != TASK_NONE, "a probe task was added");
+
+    std::vector<uint64_t> times;
+    unsigned long mostPerPass = 0;
+    for (int i = 0; i < PASSES; i++) {
+        HostAdvanceMillis(PASS_MS);
+        passRuns = 0;
+        uint64_t start = HostNanos();
+        ReefAngel.Refresh();
+        times.push_back(HostNanos() - start);
+        if (passRuns > mostPerPass) mostPerPass = passRuns;
+    }
+    std::sort(times.begin(), times.end());
+    printf("%-24s %8d passes  median %.2f us  p99 %.2f us  max %.2f us\n", "Refresh()", PASSES,
+           times[PASSES / 2] / 1000.0, times[PASSES * 99 / 100] / 1000.0, times[PASSES - 1] / 1000.0);
+    printf("%-24s %8lu runs  worst lateness %lu ms  at most %lu per pass\n", "probe tasks",
+           runs[0] + runs[1] + runs[2], worstLate, mostPerPass);
+
+    // All three fall due on the same pass, SCHEDULER_BUDGET spreads them over the next ones
+    unsigned long expected = PASSES * PASS_MS / PROBE_INTERVAL;
+    for (int i = 0; i < PROBES; i++)
+        check(runs[i] + 1 >= expected && runs[i] <= expected, "a probe task ran once per interval without drifting");
+    check(mostPerPass <= SCHEDULER_BUDGET, "no pass ran more probe tasks than SCHEDULER_BUDGET");
+    check(worstLate <= (PROBES + SCHEDULER_BUDGET - 1) / SCHEDULER_BUDGET * PASS_MS,
+          "no probe task ran later than the passes the budget needs to reach it");
+    return finish();
+}
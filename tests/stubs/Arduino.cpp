@@ -0,0 +1,154 @@
+#include "Arduino.h"
+#include "Host.h"
+#include <time.h>
+
+static unsigned long long clockMicros = 0;
+static int pinLevel[256];
+static int pinOutput[256];
+static int analogLevel[256];
+static unsigned long analogReads = 0;
+static unsigned long watchdogResets = 0;
+static unsigned long flashCompares = 0;
+uint8_t HostEEPROM[HOST_EEPROM_SIZE];
+
+void HostAdvanceMicros(unsigned long us) { clockMicros += us; }
+void HostAdvanceMillis(unsigned long ms) { clockMicros += ms * 1000ULL; }
+void HostSetMillis(unsigned long ms) { clockMicros = ms * 1000ULL; }
+
+uint64_t HostNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void HostSetDigital(uint8_t pin, int value) { pinLevel[pin] = value; }
+void HostSetAnalog(uint8_t pin, int value) { analogLevel[pin] = value; }
+int HostPinOutput(uint8_t pin) { return pinOutput[pin]; }
+unsigned long HostAnalogReads() { return analogReads; }
+unsigned long HostWatchdogResets() { return watchdogResets; }
+unsigned long HostFlashCompares() { return flashCompares; }
+
+extern "C" int strcmp_P(const char *s1, const char *s2)
+{
+    flashCompares++;
+    return strcmp(s1, s2);
+}
+
+unsigned long millis() { return (unsigned long)(clockMicros / 1000); }
+unsigned long micros() { return (unsigned long)clockMicros; }
+void delay(unsigned long ms) { clockMicros += ms * 1000ULL; }
+void delayMicroseconds(unsigned int us) { clockMicros += us; }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) { pinOutput[pin] = value; }
+int digitalRead(uint8_t pin) { return pinLevel[pin]; }
+int analogRead(uint8_t pin)
+{
+    analogReads++;
+    // A0 and 0 name the same input
+    if (pin < A0) pin += A0;
+    return analogLevel[pin];
+}
+void analogWrite(uint8_t pin, int value) { pinOutput[pin] = value; }
+void analogReference(uint8_t mode) {}
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) { return 0; }
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {}
+void noTone(uint8_t pin) {}
+void attachInterrupt(uint8_t num, void (*func)(void), int mode) {}
+void detachInterrupt(uint8_t num) {}
+
+void wdt_reset() { watchdogResets++; }
+void wdt_enable(unsigned char timeout) {}
+void wdt_disable() {}
+
+uint8_t eeprom_read_byte(const uint8_t *addr) { return HostEEPROM[(uintptr_t)addr % HOST_EEPROM_SIZE]; }
+uint16_t eeprom_read_word(const uint16_t *addr)
+{
+    uintptr_t a = (uintptr_t)addr;
+    return eeprom_read_byte((const uint8_t *)a) | (eeprom_read_byte((const uint8_t *)(a + 1)) << 8);
+}
+uint32_t eeprom_read_dword(const uint32_t *addr)
+{
+    uintptr_t a = (uintptr_t)addr;
+    return eeprom_read_word((const uint16_t *)a) | ((uint32_t)eeprom_read_word((const uint16_t *)(a + 2)) << 16);
+}
+void eeprom_write_byte(uint8_t *addr, uint8_t value) { HostEEPROM[(uintptr_t)addr % HOST_EEPROM_SIZE] = value; }
+void eeprom_write_word(uint16_t *addr, uint16_t value)
+{
+    uintptr_t a = (uintptr_t)addr;
+    eeprom_write_byte((uint8_t *)a, value & 0xff);
+    eeprom_write_byte((uint8_t *)(a + 1), value >> 8);
+}
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) ((uint8_t *)dst)[i] = eeprom_read_byte((const uint8_t *)src + i);
+}
+void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++) eeprom_write_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+void eeprom_update_block(const void *src, void *dst, size_t n) { eeprom_write_block(src, dst, n); }
+void eeprom_write_dword(uint32_t *addr, uint32_t value)
+{
+    uintptr_t a = (uintptr_t)addr;
+    eeprom_write_word((uint16_t *)a, value & 0xffff);
+    eeprom_write_word((uint16_t *)(a + 2), value >> 16);
+}
+
+static unsigned long randomState = 1;
+long random(long howbig)
+{
+    if (howbig == 0) return 0;
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (randomState >> 8) % howbig;
+}
+long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig) return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+void randomSeed(unsigned long seed) { if (seed) randomState = seed; }
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    if (in_max == in_min) return out_min;
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+static char *unsignedToString(unsigned long value, char *string, int radix)
+{
+    char tmp[33];
+    int i = 0;
+    do {
+        int d = value % radix;
+        tmp[i++] = d < 10 ? '0' + d : 'a' + d - 10;
+        value /= radix;
+    } while (value);
+    int j = 0;
+    while (i) string[j++] = tmp[--i];
+    string[j] = 0;
+    return string;
+}
+char *ultoa(unsigned long value, char *string, int radix) { return unsignedToString(value, string, radix); }
+char *utoa(unsigned int value, char *string, int radix) { return unsignedToString(value, string, radix); }
+char *ltoa(long value, char *string, int radix)
+{
+    if (value < 0 && radix == 10) {
+        string[0] = '-';
+        unsignedToString(-(unsigned long)value, string + 1, radix);
+        return string;
+    }
+    return unsignedToString((unsigned long)value, string, radix);
+}
+char *itoa(int value, char *string, int radix)
+{
+    if (radix != 10) return unsignedToString((unsigned int)value, string, radix);
+    return ltoa(value, string, radix);
+}
+char *dtostrf(double val, signed char width, unsigned char prec, char *s)
+{
+    sprintf(s, "%*.*f", width, prec, val);
+    return s;
+}
@@ -0,0 +1,122 @@
+// Host stand-in for the Arduino core, enough for the Reef Angel libraries to compile
+// and run against a virtual clock. Hardware backends live in Host.h.
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include "binary.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+inline uint16_t makeWord(uint8_t h, uint8_t l) { return (h << 8) | l; }
+#define word(...) makeWord(__VA_ARGS__)
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define A5 59
+#define A6 60
+#define A7 61
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+#define SDA 20
+#define SCL 21
+#define SS 53
+#define MOSI 51
+#define MISO 50
+#define SCK 52
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+// Functions rather than the AVR core's macros, so host headers that use the names can follow
+template<class T, class L> auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (b < a) ? b : a; }
+template<class T, class L> auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (a < b) ? b : a; }
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define round(x)     ((x)>=0?(long)((x)+0.5):(long)((x)-0.5))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x)*(x))
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) (bitvalue ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b) (1UL << (b))
+#define _BV(b) (1 << (b))
+
+#define SIGNAL(vector) void vector(void)
+#define ISR(vector, ...) void vector(void)
+#define interrupts()
+#define noInterrupts()
+#define cli()
+#define sei()
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void analogReference(uint8_t mode);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+void attachInterrupt(uint8_t num, void (*func)(void), int mode);
+void detachInterrupt(uint8_t num);
+#define digitalPinToInterrupt(p) (p)
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+char *itoa(int value, char *string, int radix);
+char *ltoa(long value, char *string, int radix);
+char *utoa(unsigned int value, char *string, int radix);
+char *ultoa(unsigned long value, char *string, int radix);
+char *dtostrf(double val, signed char width, unsigned char prec, char *s);
+
+#include "WString.h"
+#include "HardwareSerial.h"
+
+#endif
@@ -0,0 +1,68 @@
+#include "Arduino.h"
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+HardwareSerial Serial3;
+
+HardwareSerial::HardwareSerial()
+{
+    rxHead = rxTail = 0;
+    echo = false;
+    clearCapture();
+}
+
+void HardwareSerial::clearCapture()
+{
+    written = 0;
+    writes = 0;
+    capturedLength = 0;
+    captured[0] = 0;
+}
+
+int HardwareSerial::available() { return (rxHead - rxTail) & 0xff; }
+
+int HardwareSerial::read()
+{
+    if (rxHead == rxTail) return -1;
+    uint8_t c = rx[rxTail];
+    rxTail = (rxTail + 1) & 0xff;
+    return c;
+}
+
+int HardwareSerial::peek() { return rxHead == rxTail ? -1 : rx[rxTail]; }
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    writes++;
+    written += size;
+    if (echo) fwrite(buffer, 1, size, stdout);
+    for (size_t i = 0; i < size; i++) {
+        // keep the tail of the output
+        if (capturedLength == sizeof(captured) - 1) {
+            memmove(captured, captured + sizeof(captured) / 2, sizeof(captured) / 2);
+            capturedLength -= sizeof(captured) / 2;
+        }
+        captured[capturedLength++] = buffer[i];
+    }
+    captured[capturedLength] = 0;
+    return size;
+}
+
+void HardwareSerial::inject(const char *data)
+{
+    inject((const uint8_t *)data, strlen(data));
+}
+
+void HardwareSerial::inject(const uint8_t *data, size_t length)
+{
+    while (length--) {
+        rx[rxHead] = *data++;
+        rxHead = (rxHead + 1) & 0xff;
+    }
+}
@@ -0,0 +1,39 @@
+// Serial ports write to a capture buffer (or stdout) and read from a queue the test fills
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+private:
+    uint8_t rx[256];
+    uint16_t rxHead, rxTail;
+public:
+    HardwareSerial();
+    void begin(unsigned long baud) {}
+    void begin(unsigned long baud, uint8_t config) {}
+    void end() {}
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+    virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+    operator bool() { return true; }
+    // Host side
+    void inject(const char *data);
+    void inject(const uint8_t *data, size_t length);
+    bool echo;              // copy output to stdout
+    unsigned long written;  // bytes written since the last clear
+    unsigned long writes;   // write() calls since the last clear
+    char captured[1024];    // tail of the output, NUL terminated
+    size_t capturedLength;
+    void clearCapture();
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
+
+#endif
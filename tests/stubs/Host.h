@@ -0,0 +1,56 @@
+// Host side controls for the stubbed hardware: the virtual clock, pin levels,
+// the EEPROM image and the I2C devices on the Wire bus
+#ifndef Host_h
+#define Host_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Virtual clock behind millis()/micros()/delay(), only moves when told to
+void HostAdvanceMicros(unsigned long us);
+void HostAdvanceMillis(unsigned long ms);
+void HostSetMillis(unsigned long ms);
+// Real monotonic time for measuring the code under test
+uint64_t HostNanos();
+
+// Pins: inputs are set by the test, outputs can be read back
+void HostSetDigital(uint8_t pin, int value);
+void HostSetAnalog(uint8_t pin, int value);
+int HostPinOutput(uint8_t pin);
+unsigned long HostAnalogReads();
+
+// EEPROM image, 4 KB like the ATmega2560
+#define HOST_EEPROM_SIZE 4096
+extern uint8_t HostEEPROM[HOST_EEPROM_SIZE];
+
+// Watchdog resets since start
+unsigned long HostWatchdogResets();
+
+// strcmp_P() calls since start
+unsigned long HostFlashCompares();
+
+// An I2C device answers reads from a register file and records writes.
+// Devices not registered NACK like an empty socket.
+class HostI2CDevice {
+public:
+    HostI2CDevice(uint8_t address);
+    virtual ~HostI2CDevice();
+    uint8_t address;
+    // Called for each byte a master writes, after the address
+    virtual void receive(uint8_t data);
+    // Called when a transmission to this device ends
+    virtual void stop() {}
+    // Next byte for a master read
+    virtual uint8_t send();
+    uint8_t last[32];       // bytes of the last transmission
+    uint8_t lastLength;
+    unsigned long transmissions;
+    uint8_t reply[32];      // bytes returned by reads, repeating from the start
+    uint8_t replyLength;
+    uint8_t replyPos;
+    HostI2CDevice *next;
+};
+HostI2CDevice *HostFindI2C(uint8_t address);
+unsigned long HostI2CTransmissions();
+
+#endif
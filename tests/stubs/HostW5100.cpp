@@ -0,0 +1,318 @@
+#include "HostW5100.h"
+
+#define SOCKET_BASE 0x0400
+#define SOCKET_SIZE 0x0100
+#define TX_BASE     0x4000
+#define RX_BASE     0x6000
+#define BUF_SIZE    0x0800
+#define BUF_MASK    0x07FF
+
+// Socket register offsets
+#define SN_MR       0x00
+#define SN_CR       0x01
+#define SN_IR       0x02
+#define SN_SR       0x03
+#define SN_PORT     0x04
+#define SN_DPORT    0x10
+#define SN_TX_FSR   0x20
+#define SN_TX_RD    0x22
+#define SN_TX_WR    0x24
+#define SN_RX_RSR   0x26
+#define SN_RX_RD    0x28
+
+#define CR_OPEN     0x01
+#define CR_LISTEN   0x02
+#define CR_CONNECT  0x04
+#define CR_DISCON   0x08
+#define CR_CLOSE    0x10
+#define CR_SEND     0x20
+
+#define IR_SEND_OK  0x10
+#define IR_TIMEOUT  0x08
+
+#define SR_CLOSED       0x00
+#define SR_INIT         0x13
+#define SR_LISTEN       0x14
+#define SR_ESTABLISHED  0x17
+#define SR_CLOSE_WAIT   0x1C
+#define SR_UDP          0x22
+
+HostW5100 HostEthernet;
+
+static HostPeer *peers = NULL;
+
+HostPeer::HostPeer(uint16_t port)
+{
+    this->port = port;
+    socket = -1;
+    next = peers;
+    peers = this;
+}
+
+HostPeer::~HostPeer()
+{
+    for (HostPeer **p = &peers; *p; p = &(*p)->next)
+        if (*p == this) {
+            *p = next;
+            break;
+        }
+}
+
+void HostPeer::send(const uint8_t *data, size_t len)
+{
+    if (socket >= 0) HostEthernet.send(socket, data, len);
+}
+
+void HostPeer::send(const char *text)
+{
+    send((const uint8_t *)text, strlen(text));
+}
+
+void HostPeer::close()
+{
+    if (socket >= 0) HostEthernet.close(socket);
+}
+
+HostW5100::HostW5100() : HostSPIDevice(53)
+{
+    memset(mem, 0, sizeof(mem));
+    memset(rxWrite, 0, sizeof(rxWrite));
+    memset(peer, 0, sizeof(peer));
+    frame = 0;
+    resetCounters();
+}
+
+void HostW5100::resetCounters()
+{
+    frames = 0;
+    leases = 0;
+    memset(sizeReads, 0, sizeof(sizeReads));
+    memset(sends, 0, sizeof(sends));
+}
+
+// Every access is one frame: opcode, address high, address low, data
+uint8_t HostW5100::transfer(uint8_t data)
+{
+    uint8_t r = 0;
+    switch (frame) {
+        case 0: op = data; break;
+        case 1: addr = data << 8; break;
+        case 2: addr |= data; break;
+        case 3:
+            frames++;
+            if (op == 0xF0) write(addr, data);
+            else if (op == 0x0F) r = read(addr);
+            break;
+    }
+    frame = (frame + 1) & 3;
+    return r;
+}
+
+uint16_t HostW5100::reg16(int s, uint8_t r)
+{
+    uint16_t a = SOCKET_BASE + s * SOCKET_SIZE + r;
+    return (mem[a] << 8) | mem[a + 1];
+}
+
+void HostW5100::setReg16(int s, uint8_t r, uint16_t v)
+{
+    uint16_t a = SOCKET_BASE + s * SOCKET_SIZE + r;
+    mem[a] = v >> 8;
+    mem[a + 1] = v & 0xFF;
+}
+
+uint8_t HostW5100::read(uint16_t a)
+{
+    if (a >= SOCKET_BASE && a < SOCKET_BASE + HOST_SOCKETS * SOCKET_SIZE) {
+        int s = (a - SOCKET_BASE) / SOCKET_SIZE;
+        uint8_t r = a & 0xFF;
+        if (r == SN_RX_RSR || r == SN_RX_RSR + 1) {
+            uint16_t size = rxWrite[s] - reg16(s, SN_RX_RD);
+            if (r == SN_RX_RSR) sizeReads[s]++;
+            return r == SN_RX_RSR ? size >> 8 : size & 0xFF;
+        }
+        if (r == SN_TX_FSR || r == SN_TX_FSR + 1) {
+            uint16_t size = BUF_SIZE - (uint16_t)(reg16(s, SN_TX_WR) - reg16(s, SN_TX_RD));
+            return r == SN_TX_FSR ? size >> 8 : size & 0xFF;
+        }
+    }
+    return mem[a & 0x7FFF];
+}
+
+void HostW5100::write(uint16_t a, uint8_t v)
+{
+    a &= 0x7FFF;
+    if (a == 0 && (v & 0x80)) {
+        // Software reset
+        memset(mem, 0, SOCKET_BASE + HOST_SOCKETS * SOCKET_SIZE);
+        memset(rxWrite, 0, sizeof(rxWrite));
+        return;
+    }
+    if (a >= SOCKET_BASE && a < SOCKET_BASE + HOST_SOCKETS * SOCKET_SIZE) {
+        int s = (a - SOCKET_BASE) / SOCKET_SIZE;
+        uint8_t r = a & 0xFF;
+        if (r == SN_CR) {
+            command(s, v);
+            return;
+        }
+        if (r == SN_IR) {
+            mem[a] &= ~v;
+            return;
+        }
+    }
+    mem[a] = v;
+}
+
+void HostW5100::command(int s, uint8_t cmd)
+{
+    uint16_t base = SOCKET_BASE + s * SOCKET_SIZE;
+    uint8_t &sr = mem[base + SN_SR];
+    switch (cmd) {
+        case CR_OPEN:
+            sr = (mem[base + SN_MR] & 0x0F) == 2 ? SR_UDP : SR_INIT;
+            rxWrite[s] = reg16(s, SN_RX_RD);
+            setReg16(s, SN_TX_RD, reg16(s, SN_TX_WR));
+            out[s].clear();
+            break;
+        case CR_LISTEN:
+            if (sr == SR_INIT) sr = SR_LISTEN;
+            break;
+        case CR_CONNECT: {
+            uint16_t port = reg16(s, SN_DPORT);
+            HostPeer *p;
+            for (p = peers; p; p = p->next)
+                if (p->port == port && p->socket < 0) break;
+            if (p) {
+                sr = SR_ESTABLISHED;
+                p->socket = s;
+                peer[s] = p;
+                p->connected();
+            }
+            else {
+                sr = SR_CLOSED;
+                mem[base + SN_IR] |= IR_TIMEOUT;
+            }
+            break;
+        }
+        case CR_DISCON:
+        case CR_CLOSE:
+            sr = SR_CLOSED;
+            if (peer[s]) {
+                HostPeer *p = peer[s];
+                peer[s] = NULL;
+                p->socket = -1;
+                p->closed();
+            }
+            break;
+        case CR_SEND:
+            transmit(s);
+            mem[base + SN_IR] |= IR_SEND_OK;
+            break;
+    }
+}
+
+void HostW5100::transmit(int s)
+{
+    uint16_t rd = reg16(s, SN_TX_RD);
+    uint16_t wr = reg16(s, SN_TX_WR);
+    std::string data;
+    for (uint16_t p = rd; p != wr; p++) data += (char)mem[TX_BASE + s * BUF_SIZE + (p & BUF_MASK)];
+    setReg16(s, SN_TX_RD, wr);
+    sends[s]++;
+    if (mem[SOCKET_BASE + s * SOCKET_SIZE + SN_SR] == SR_UDP) {
+        if (reg16(s, SN_DPORT) == 67) dhcp(s, (const uint8_t *)data.data(), data.size());
+        return;
+    }
+    out[s] += data;
+    if (peer[s]) peer[s]->receive((const uint8_t *)data.data(), data.size());
+}
+
+// Answers DISCOVER with an OFFER and REQUEST with an ACK for 192.168.1.50
+void HostW5100::dhcp(int s, const uint8_t *request, size_t len)
+{
+    if (len < 240 || request[0] != 1) return;
+    uint8_t type = 0;
+    for (size_t i = 240; i + 1 < len && request[i] != 255; i += request[i] ? request[i + 1] + 2 : 1)
+        if (request[i] == 53) type = request[i + 2];
+    if (type != 1 && type != 3) return;
+
+    uint8_t reply[8 + 300];
+    memset(reply, 0, sizeof(reply));
+    const uint8_t server[4] = { 192, 168, 1, 1 };
+    memcpy(reply, server, 4);
+    reply[4] = 0;
+    reply[5] = 67;
+    reply[6] = 300 >> 8;
+    reply[7] = 300 & 0xFF;
+    uint8_t *b = reply + 8;
+    b[0] = 2;
+    b[1] = 1;
+    b[2] = 6;
+    memcpy(b + 4, request + 4, 4);      // xid
+    b[16] = 192; b[17] = 168; b[18] = 1; b[19] = 50;
+    memcpy(b + 28, request + 28, 16);   // chaddr
+    const uint8_t options[] = {
+        0x63, 0x82, 0x53, 0x63,
+        53, 1, (uint8_t)(type == 1 ? 2 : 5),
+        54, 4, 192, 168, 1, 1,
+        1, 4, 255, 255, 255, 0,
+        3, 4, 192, 168, 1, 1,
+        6, 4, 192, 168, 1, 1,
+        51, 4, 0, 1, 0x51, 0x80,
+        255
+    };
+    memcpy(b + 236, options, sizeof(options));
+    if (type == 3) leases++;
+    send(s, reply, sizeof(reply));
+}
+
+int HostW5100::connect(uint16_t port)
+{
+    for (int s = 0; s < HOST_SOCKETS; s++) {
+        uint16_t base = SOCKET_BASE + s * SOCKET_SIZE;
+        if (mem[base + SN_SR] == SR_LISTEN && reg16(s, SN_PORT) == port) {
+            mem[base + SN_SR] = SR_ESTABLISHED;
+            out[s].clear();
+            return s;
+        }
+    }
+    return -1;
+}
+
+uint16_t HostW5100::rxFree(int s)
+{
+    return BUF_SIZE - (uint16_t)(rxWrite[s] - reg16(s, SN_RX_RD));
+}
+
+size_t HostW5100::send(int s, const uint8_t *data, size_t len)
+{
+    uint16_t room = rxFree(s);
+    if (len > room) len = room;
+    for (size_t i = 0; i < len; i++) mem[RX_BASE + s * BUF_SIZE + (rxWrite[s]++ & BUF_MASK)] = data[i];
+    return len;
+}
+
+size_t HostW5100::send(int s, const char *text)
+{
+    return send(s, (const uint8_t *)text, strlen(text));
+}
+
+void HostW5100::close(int s)
+{
+    uint8_t &sr = mem[SOCKET_BASE + s * SOCKET_SIZE + SN_SR];
+    if (sr == SR_ESTABLISHED) sr = SR_CLOSE_WAIT;
+}
+
+uint8_t HostW5100::status(int s)
+{
+    if (s < 0) return SR_CLOSED;
+    return mem[SOCKET_BASE + s * SOCKET_SIZE + SN_SR];
+}
+
+std::string HostW5100::take(int s)
+{
+    if (s < 0) return std::string();
+    std::string r = out[s];
+    out[s].clear();
+    return r;
+}
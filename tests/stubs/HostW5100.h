@@ -0,0 +1,78 @@
+// A W5100 on the SPI bus (chip select pin 53), emulated at the register level so the
+// real Ethernet, EthernetDHCP and PubSubClient code runs unchanged on top of it.
+// The host side plays the network: it answers DHCP, accepts connections to the
+// listening sockets, and stands in for the remote end of outgoing connections.
+#ifndef HostW5100_h
+#define HostW5100_h
+
+#include <SPI.h>
+#include <string>
+
+#define HOST_SOCKETS 4
+
+// The far end of an outgoing TCP connection, registered for a port
+class HostPeer {
+public:
+    HostPeer(uint16_t port);
+    virtual ~HostPeer();
+    uint16_t port;
+    int socket;                 // socket connected to this peer, -1 if none
+    // Bytes the controller sent
+    virtual void receive(const uint8_t *data, size_t len) {}
+    virtual void connected() {}
+    virtual void closed() {}
+    // Queue bytes for the controller to read
+    void send(const uint8_t *data, size_t len);
+    void send(const char *text);
+    void close();
+    HostPeer *next;
+};
+
+class HostW5100 : public HostSPIDevice {
+public:
+    HostW5100();
+    uint8_t transfer(uint8_t data);
+    void select() { frame = 0; }
+
+    // Open a connection from a client to the socket listening on port, returns the
+    // socket number or -1 when nothing listens there
+    int connect(uint16_t port);
+    // Bytes from the remote end, they are refused past the 2 KB receive buffer
+    size_t send(int s, const uint8_t *data, size_t len);
+    size_t send(int s, const char *text);
+    // The remote end closes its side
+    void close(int s);
+    uint8_t status(int s);
+    // Everything the controller sent on a socket since the last take()
+    std::string take(int s);
+    // Free space left in a socket's receive buffer
+    uint16_t rxFree(int s);
+
+    // Counters
+    unsigned long frames;               // 4 byte SPI frames
+    unsigned long sizeReads[HOST_SOCKETS];  // Sn_RX_RSR reads
+    unsigned long sends[HOST_SOCKETS];  // SEND commands
+    unsigned long leases;               // DHCP ACKs handed out
+    void resetCounters();
+
+private:
+    uint8_t mem[0x8000];
+    uint8_t frame;
+    uint8_t op;
+    uint16_t addr;
+    uint16_t rxWrite[HOST_SOCKETS];     // where the next received byte goes
+    std::string out[HOST_SOCKETS];
+    HostPeer *peer[HOST_SOCKETS];
+    uint8_t read(uint16_t a);
+    void write(uint16_t a, uint8_t v);
+    void command(int s, uint8_t cmd);
+    void transmit(int s);
+    void dhcp(int s, const uint8_t *request, size_t len);
+    uint16_t reg16(int s, uint8_t r);
+    void setReg16(int s, uint8_t r, uint16_t v);
+    friend class HostPeer;
+};
+
+extern HostW5100 HostEthernet;
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+#include "Printable.h"
+#include "WString.h"
+
+class IPAddress : public Printable {
+private:
+    union {
+        uint8_t bytes[4];
+        uint32_t dword;
+    } _address;
+    uint8_t *raw_address() { return _address.bytes; }
+public:
+    IPAddress() { _address.dword = 0; }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { _address.bytes[0] = a; _address.bytes[1] = b; _address.bytes[2] = c; _address.bytes[3] = d; }
+    IPAddress(uint32_t address) { _address.dword = address; }
+    IPAddress(const uint8_t *address) { memcpy(_address.bytes, address, 4); }
+    operator uint32_t() const { return _address.dword; }
+    bool operator==(const IPAddress &addr) const { return _address.dword == addr._address.dword; }
+    bool operator==(const uint8_t *addr) const { return memcmp(addr, _address.bytes, 4) == 0; }
+    uint8_t operator[](int index) const { return _address.bytes[index]; }
+    uint8_t &operator[](int index) { return _address.bytes[index]; }
+    IPAddress &operator=(const uint8_t *address) { memcpy(_address.bytes, address, 4); return *this; }
+    IPAddress &operator=(uint32_t address) { _address.dword = address; return *this; }
+    virtual size_t printTo(Print &p) const;
+    friend class EthernetClass;
+    friend class UDP;
+    friend class Client;
+    friend class Server;
+    friend class DhcpClass;
+    friend class DNSClient;
+};
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+#endif
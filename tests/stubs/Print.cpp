@@ -0,0 +1,111 @@
+#include "Arduino.h"
+#include "IPAddress.h"
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--) {
+        if (write(*buffer++)) n++;
+        else break;
+    }
+    return n;
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+    char buf[8 * sizeof(long) + 1];
+    if (base < 2) base = 10;
+    ultoa(n, buf, base);
+    for (char *p = buf; *p; p++) *p = toupper(*p);
+    return write(buf);
+}
+
+size_t Print::print(const __FlashStringHelper *s) { return write((const char *)s); }
+size_t Print::print(const String &s) { return write(s.c_str(), s.length()); }
+size_t Print::print(const char str[]) { return write(str); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char b, int base) { return print((unsigned long)b, base); }
+size_t Print::print(int n, int base) { return print((long)n, base); }
+size_t Print::print(unsigned int n, int base) { return print((unsigned long)n, base); }
+size_t Print::print(long n, int base)
+{
+    if (base == 0) return write((uint8_t)n);
+    if (base == 10 && n < 0) return print('-') + printNumber(-(unsigned long)n, 10);
+    return printNumber((unsigned long)n, base);
+}
+size_t Print::print(unsigned long n, int base)
+{
+    if (base == 0) return write((uint8_t)n);
+    return printNumber(n, base);
+}
+size_t Print::print(double n, int digits)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return write(buf);
+}
+size_t Print::print(const Printable &x) { return x.printTo(*this); }
+
+size_t Print::println(void) { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper *s) { return print(s) + println(); }
+size_t Print::println(const String &s) { return print(s) + println(); }
+size_t Print::println(const char c[]) { return print(c) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char b, int base) { return print(b, base) + println(); }
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) { return print(n, base) + println(); }
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) { return print(n, base) + println(); }
+size_t Print::println(double n, int digits) { return print(n, digits) + println(); }
+size_t Print::println(const Printable &x) { return print(x) + println(); }
+
+bool Stream::find(const char *target)
+{
+    return find(target, strlen(target));
+}
+
+bool Stream::find(const char *target, size_t length)
+{
+    // No blocking on the host: only what is already available is searched
+    size_t index = 0;
+    if (length == 0) return true;
+    while (available()) {
+        int c = read();
+        if (c == target[index]) {
+            if (++index >= length) return true;
+        }
+        else index = (c == target[0]) ? 1 : 0;
+    }
+    return false;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length && available()) buffer[count++] = read();
+    return count;
+}
+
+long Stream::parseInt()
+{
+    long value = 0;
+    bool negative = false;
+    int c;
+    while (available() && (c = peek()) != '-' && !isdigit(c)) read();
+    if (available() && peek() == '-') {
+        negative = true;
+        read();
+    }
+    while (available() && isdigit(peek())) value = value * 10 + read() - '0';
+    return negative ? -value : value;
+}
+
+size_t IPAddress::printTo(Print &p) const
+{
+    size_t n = 0;
+    for (int i = 0; i < 3; i++) {
+        n += p.print(_address.bytes[i], 10);
+        n += p.print('.');
+    }
+    return n + p.print(_address.bytes[3], 10);
+}
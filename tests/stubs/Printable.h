@@ -0,0 +1,4 @@
+#ifndef Printable_h
+#define Printable_h
+#include "Print.h"
+#endif
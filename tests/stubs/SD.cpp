@@ -0,0 +1,82 @@
+#include <string>
+#include <vector>
+#include <map>
+#include "SD.h"
+
+struct HostFile {
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+static std::map<std::string, HostFile *> files;
+
+SDClass SD;
+
+bool SDClass::begin(uint8_t csPin) { return true; }
+
+File SDClass::open(const char *filename, uint8_t mode)
+{
+    HostFile *f = files.count(filename) ? files[filename] : NULL;
+    if (!f) {
+        if (!(mode & O_CREAT)) return File();
+        f = new HostFile;
+        f->name = filename;
+        files[filename] = f;
+    }
+    if (mode & O_TRUNC) f->data.clear();
+    return File(f, mode);
+}
+
+bool SDClass::exists(const char *filename) { return files.count(filename) != 0; }
+
+bool SDClass::remove(const char *filename)
+{
+    if (!files.count(filename)) return false;
+    delete files[filename];
+    files.erase(filename);
+    return true;
+}
+
+File::File() : file(NULL), pos(0), mode(0) {}
+File::File(HostFile *file, uint8_t mode) : file(file), pos(0), mode(mode)
+{
+    if (mode & O_APPEND) pos = file->data.size();
+}
+
+size_t File::write(uint8_t b) { return write(&b, 1); }
+
+size_t File::write(const uint8_t *buf, size_t size)
+{
+    if (!file || !(mode & O_WRITE)) return 0;
+    if (mode & O_APPEND) pos = file->data.size();
+    if (file->data.size() < pos + size) file->data.resize(pos + size);
+    memcpy(&file->data[pos], buf, size);
+    pos += size;
+    SD.bytesWritten += size;
+    SD.writeCalls++;
+    return size;
+}
+
+int File::read()
+{
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int File::read(void *buf, uint16_t nbyte)
+{
+    if (!file) return -1;
+    uint32_t n = file->data.size() - pos;
+    if (n > nbyte) n = nbyte;
+    if (n) memcpy(buf, &file->data[pos], n);
+    pos += n;
+    SD.bytesRead += n;
+    return n;
+}
+
+int File::peek() { return file && pos < file->data.size() ? file->data[pos] : -1; }
+int File::available() { return file ? file->data.size() - pos : 0; }
+bool File::seek(uint32_t p) { if (!file || p > file->data.size()) return false; pos = p; return true; }
+uint32_t File::size() { return file ? file->data.size() : 0; }
+void File::close() { file = NULL; }
+const char *File::name() { return file ? file->name.c_str() : ""; }
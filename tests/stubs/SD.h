@@ -0,0 +1,59 @@
+// SD card with files kept in memory
+#ifndef __SD_H__
+#define __SD_H__
+
+#include <Arduino.h>
+
+#define O_READ 0x01
+#define O_RDONLY O_READ
+#define O_WRITE 0x02
+#define O_WRONLY O_WRITE
+#define O_RDWR (O_READ | O_WRITE)
+#define O_APPEND 0x04
+#define O_CREAT 0x10
+#define O_TRUNC 0x40
+#define FILE_READ O_READ
+#define FILE_WRITE (O_READ | O_WRITE | O_CREAT | O_APPEND)
+
+struct HostFile;
+
+class File : public Stream {
+private:
+    HostFile *file;
+    uint32_t pos;
+    uint8_t mode;
+public:
+    File();
+    File(HostFile *file, uint8_t mode);
+    virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *buf, size_t size);
+    using Print::write;
+    virtual int read();
+    int read(void *buf, uint16_t nbyte);
+    virtual int peek();
+    virtual int available();
+    virtual void flush() {}
+    bool seek(uint32_t pos);
+    uint32_t position() { return pos; }
+    uint32_t size();
+    void close();
+    operator bool() { return file != NULL; }
+    const char *name();
+};
+
+class SDClass {
+public:
+    bool begin(uint8_t csPin = 4);
+    File open(const char *filename, uint8_t mode = FILE_READ);
+    bool exists(const char *filename);
+    bool remove(const char *filename);
+    bool mkdir(const char *filename) { return true; }
+    // Host side
+    unsigned long bytesWritten;
+    unsigned long writeCalls;
+    unsigned long bytesRead;
+};
+
+extern SDClass SD;
+
+#endif
@@ -0,0 +1,67 @@
+#include "SPI.h"
+#include <avr/io.h>
+
+SPIClass SPI;
+unsigned long SPIClass::transfers = 0;
+
+static HostSPIDevice *devices = NULL;
+static HostSPIDevice *selected = NULL;
+
+HostSPIDevice::HostSPIDevice(uint8_t csPin)
+{
+    this->csPin = csPin;
+    next = devices;
+    devices = this;
+}
+
+HostSPIDevice::~HostSPIDevice()
+{
+    if (selected == this) selected = NULL;
+    for (HostSPIDevice **d = &devices; *d; d = &(*d)->next)
+        if (*d == this) {
+            *d = next;
+            break;
+        }
+}
+
+void SPIClass::chipSelect(uint8_t pin, uint8_t level)
+{
+    for (HostSPIDevice *d = devices; d; d = d->next) {
+        if (d->csPin != pin) continue;
+        if (level == LOW && selected != d) {
+            selected = d;
+            d->select();
+        }
+        else if (level == HIGH && selected == d) {
+            d->deselect();
+            selected = NULL;
+        }
+    }
+}
+
+// PB0 is SS, pin 53, on the ATmega2560
+void HostPortWrite(char port, uint8_t before, uint8_t after)
+{
+    if (port == 'B' && ((before ^ after) & 1)) SPIClass::chipSelect(53, after & 1);
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+    transfers++;
+    return selected ? selected->transfer(data) : 0;
+}
+
+uint16_t SPIClass::transfer16(uint16_t data)
+{
+    uint16_t hi = transfer(data >> 8);
+    return (hi << 8) | transfer(data & 0xff);
+}
+
+void SPIClass::transfer(void *buf, size_t count)
+{
+    uint8_t *p = (uint8_t *)buf;
+    while (count--) {
+        *p = transfer(*p);
+        p++;
+    }
+}
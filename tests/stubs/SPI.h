@@ -0,0 +1,56 @@
+// SPI on the host forwards each transfer to whichever HostSPIDevice is selected
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#include <Arduino.h>
+
+#define SPI_CLOCK_DIV2 0x04
+#define SPI_CLOCK_DIV4 0x00
+#define SPI_CLOCK_DIV8 0x05
+#define SPI_CLOCK_DIV16 0x01
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+class SPISettings {
+public:
+    SPISettings() {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+// A device on the bus sees every byte while its chip select is low
+class HostSPIDevice {
+public:
+    HostSPIDevice(uint8_t csPin);
+    virtual ~HostSPIDevice();
+    uint8_t csPin;
+    virtual void select() {}
+    virtual uint8_t transfer(uint8_t data) = 0;
+    virtual void deselect() {}
+    HostSPIDevice *next;
+};
+
+class SPIClass {
+public:
+    static void begin() {}
+    static void end() {}
+    static void beginTransaction(SPISettings settings) {}
+    static void endTransaction() {}
+    static void usingInterrupt(uint8_t) {}
+    static uint8_t transfer(uint8_t data);
+    static uint16_t transfer16(uint16_t data);
+    static void transfer(void *buf, size_t count);
+    static void setBitOrder(uint8_t) {}
+    static void setDataMode(uint8_t) {}
+    static void setClockDivider(uint8_t) {}
+    // Host side
+    static unsigned long transfers;
+    static void chipSelect(uint8_t pin, uint8_t level);
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef Stream_h
+#define Stream_h
+
+#include "Print.h"
+
+class Stream : public Print {
+protected:
+    unsigned long _timeout;
+public:
+    Stream() : _timeout(1000) {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    bool find(const char *target);
+    bool find(const char *target, size_t length);
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    long parseInt();
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "Arduino.h"
+
+void String::assign(const char *s, unsigned int n)
+{
+    char *b = (char *)malloc(n + 1);
+    memcpy(b, s, n);
+    b[n] = 0;
+    free(buffer);
+    buffer = b;
+    len = n;
+}
+
+String::String(const char *cstr) : buffer(NULL), len(0) { assign(cstr ? cstr : "", cstr ? strlen(cstr) : 0); }
+String::String(const String &str) : buffer(NULL), len(0) { assign(str.buffer, str.len); }
+String::String(const __FlashStringHelper *str) : buffer(NULL), len(0) { assign((const char *)str, strlen((const char *)str)); }
+String::String(char c) : buffer(NULL), len(0) { assign(&c, 1); }
+String::String(unsigned char value, unsigned char base) : buffer(NULL), len(0) { char b[9]; utoa(value, b, base); assign(b, strlen(b)); }
+String::String(int value, unsigned char base) : buffer(NULL), len(0) { char b[34]; itoa(value, b, base); assign(b, strlen(b)); }
+String::String(unsigned int value, unsigned char base) : buffer(NULL), len(0) { char b[34]; utoa(value, b, base); assign(b, strlen(b)); }
+String::String(long value, unsigned char base) : buffer(NULL), len(0) { char b[34]; ltoa(value, b, base); assign(b, strlen(b)); }
+String::String(unsigned long value, unsigned char base) : buffer(NULL), len(0) { char b[34]; ultoa(value, b, base); assign(b, strlen(b)); }
+String::String(double value, unsigned char decimalPlaces) : buffer(NULL), len(0) { char b[34]; snprintf(b, sizeof(b), "%.*f", decimalPlaces, value); assign(b, strlen(b)); }
+String::~String() { free(buffer); }
+
+String &String::operator=(const String &rhs) { if (this != &rhs) assign(rhs.buffer, rhs.len); return *this; }
+String &String::operator=(const char *cstr) { assign(cstr, strlen(cstr)); return *this; }
+
+String &String::operator+=(const String &rhs)
+{
+    String copy(rhs);
+    char *b = (char *)malloc(len + copy.len + 1);
+    memcpy(b, buffer, len);
+    memcpy(b + len, copy.buffer, copy.len + 1);
+    free(buffer);
+    buffer = b;
+    len += copy.len;
+    return *this;
+}
+String &String::operator+=(const char *cstr) { return *this += String(cstr); }
+String &String::operator+=(char c) { return *this += String(c); }
+
+int String::indexOf(char c, unsigned int from) const
+{
+    if (from >= len) return -1;
+    const char *p = strchr(buffer + from, c);
+    return p ? p - buffer : -1;
+}
+
+int String::indexOf(const String &s, unsigned int from) const
+{
+    if (from >= len) return -1;
+    const char *p = strstr(buffer + from, s.buffer);
+    return p ? p - buffer : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from > len) from = len;
+    if (to > len) to = len;
+    String out;
+    out.assign(buffer + from, to - from);
+    return out;
+}
+
+void String::toCharArray(char *buf, unsigned int bufsize, unsigned int index) const
+{
+    if (!bufsize || !buf) return;
+    if (index >= len) { buf[0] = 0; return; }
+    unsigned int n = bufsize - 1;
+    if (n > len - index) n = len - index;
+    memcpy(buf, buffer + index, n);
+    buf[n] = 0;
+}
+
+void String::toLowerCase() { for (unsigned int i = 0; i < len; i++) buffer[i] = tolower(buffer[i]); }
+void String::toUpperCase() { for (unsigned int i = 0; i < len; i++) buffer[i] = toupper(buffer[i]); }
+
+void String::trim()
+{
+    unsigned int start = 0, end = len;
+    while (start < end && isspace(buffer[start])) start++;
+    while (end > start && isspace(buffer[end - 1])) end--;
+    String t = substring(start, end);
+    *this = t;
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+    if (index >= len) return;
+    if (count > len - index) count = len - index;
+    memmove(buffer + index, buffer + index + count, len - index - count + 1);
+    len -= count;
+}
+
+void String::replace(const String &find, const String &replace)
+{
+    if (find.len == 0) return;
+    String out;
+    unsigned int i = 0;
+    while (i < len) {
+        if (strncmp(buffer + i, find.buffer, find.len) == 0) {
+            out += replace;
+            i += find.len;
+        }
+        else out += buffer[i++];
+    }
+    *this = out;
+}
+
+String operator+(const String &lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const String &lhs, const char *rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const char *lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const String &lhs, char rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const String &lhs, int rhs) { String s(lhs); s += String(rhs); return s; }
+String operator+(const String &lhs, long rhs) { String s(lhs); s += String(rhs); return s; }
+String operator+(const String &lhs, unsigned int rhs) { String s(lhs); s += String(rhs); return s; }
+String operator+(const String &lhs, unsigned long rhs) { String s(lhs); s += String(rhs); return s; }
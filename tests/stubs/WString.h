@@ -0,0 +1,79 @@
+// Small heap backed String with the parts of the Arduino API the libraries use
+#ifndef WString_h
+#define WString_h
+
+#include <stdlib.h>
+#include <string.h>
+
+class __FlashStringHelper;
+
+class String {
+private:
+    char *buffer;
+    unsigned int len;
+    void assign(const char *s, unsigned int n);
+public:
+    String(const char *cstr = "");
+    String(const String &str);
+    String(const __FlashStringHelper *str);
+    explicit String(char c);
+    explicit String(unsigned char, unsigned char base = 10);
+    explicit String(int, unsigned char base = 10);
+    explicit String(unsigned int, unsigned char base = 10);
+    explicit String(long, unsigned char base = 10);
+    explicit String(unsigned long, unsigned char base = 10);
+    explicit String(double, unsigned char decimalPlaces = 2);
+    ~String();
+    String &operator=(const String &rhs);
+    String &operator=(const char *cstr);
+    String &operator+=(const String &rhs);
+    String &operator+=(const char *cstr);
+    String &operator+=(char c);
+    String &operator+=(int n) { return *this += String(n); }
+    String &operator+=(long n) { return *this += String(n); }
+    String &operator+=(unsigned int n) { return *this += String(n); }
+    String &operator+=(unsigned long n) { return *this += String(n); }
+    unsigned char concat(const String &s) { *this += s; return 1; }
+    unsigned char concat(const char *s) { *this += s; return 1; }
+    unsigned char concat(char c) { *this += c; return 1; }
+    unsigned int length() const { return len; }
+    const char *c_str() const { return buffer; }
+    char charAt(unsigned int index) const { return index < len ? buffer[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char &operator[](unsigned int index) { return buffer[index]; }
+    void setCharAt(unsigned int index, char c) { if (index < len) buffer[index] = c; }
+    bool equals(const String &s) const { return len == s.len && strcmp(buffer, s.buffer) == 0; }
+    bool equals(const char *s) const { return strcmp(buffer, s) == 0; }
+    bool operator==(const String &s) const { return equals(s); }
+    bool operator==(const char *s) const { return equals(s); }
+    bool operator!=(const String &s) const { return !equals(s); }
+    bool operator!=(const char *s) const { return !equals(s); }
+    bool startsWith(const String &prefix) const { return prefix.len <= len && strncmp(buffer, prefix.buffer, prefix.len) == 0; }
+    bool endsWith(const String &suffix) const { return suffix.len <= len && strcmp(buffer + len - suffix.len, suffix.buffer) == 0; }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String &s, unsigned int from = 0) const;
+    String substring(unsigned int from) const { return substring(from, len); }
+    String substring(unsigned int from, unsigned int to) const;
+    void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const;
+    void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const { toCharArray((char *)buf, bufsize, index); }
+    long toInt() const { return atol(buffer); }
+    float toFloat() const { return atof(buffer); }
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    void remove(unsigned int index) { remove(index, len - index); }
+    void remove(unsigned int index, unsigned int count);
+    void replace(const String &find, const String &replace);
+    void reserve(unsigned int) {}
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char *rhs);
+String operator+(const char *lhs, const String &rhs);
+String operator+(const String &lhs, char rhs);
+String operator+(const String &lhs, int rhs);
+String operator+(const String &lhs, long rhs);
+String operator+(const String &lhs, unsigned int rhs);
+String operator+(const String &lhs, unsigned long rhs);
+
+#endif
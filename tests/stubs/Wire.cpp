@@ -0,0 +1,111 @@
+#include "Wire.h"
+#include "Host.h"
+
+static HostI2CDevice *devices = NULL;
+static unsigned long transmissions = 0;
+
+HostI2CDevice::HostI2CDevice(uint8_t address)
+{
+    this->address = address;
+    lastLength = 0;
+    transmissions = 0;
+    replyLength = 0;
+    replyPos = 0;
+    next = devices;
+    devices = this;
+}
+
+HostI2CDevice::~HostI2CDevice()
+{
+    for (HostI2CDevice **d = &devices; *d; d = &(*d)->next)
+        if (*d == this) {
+            *d = next;
+            break;
+        }
+}
+
+void HostI2CDevice::receive(uint8_t data)
+{
+    if (lastLength < sizeof(last)) last[lastLength++] = data;
+}
+
+uint8_t HostI2CDevice::send()
+{
+    if (replyLength == 0) return 0;
+    uint8_t b = reply[replyPos++];
+    if (replyPos == replyLength) replyPos = 0;
+    return b;
+}
+
+HostI2CDevice *HostFindI2C(uint8_t address)
+{
+    for (HostI2CDevice *d = devices; d; d = d->next)
+        if (d->address == address) return d;
+    return NULL;
+}
+
+unsigned long HostI2CTransmissions() { return transmissions; }
+
+TwoWire Wire;
+
+TwoWire::TwoWire()
+{
+    txAddress = 0;
+    txLength = 0;
+    rxIndex = 0;
+    rxLength = 0;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    txAddress = address;
+    txLength = 0;
+    HostI2CDevice *d = HostFindI2C(address);
+    if (d) d->lastLength = 0;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t sendStop)
+{
+    transmissions++;
+    HostI2CDevice *d = HostFindI2C(txAddress);
+    // 2 is the AVR twi code for an address NACK
+    if (!d) return 2;
+    d->transmissions++;
+    d->stop();
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (txLength == BUFFER_LENGTH) return 0;
+    txLength++;
+    HostI2CDevice *d = HostFindI2C(txAddress);
+    if (d) d->receive(data);
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity)
+{
+    for (size_t i = 0; i < quantity; i++)
+        if (!write(data[i])) return i;
+    return quantity;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+    transmissions++;
+    rxIndex = 0;
+    rxLength = 0;
+    HostI2CDevice *d = HostFindI2C(address);
+    if (!d) return 0;
+    d->transmissions++;
+    if (quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+    d->replyPos = 0;
+    for (uint8_t i = 0; i < quantity; i++) rxBuffer[i] = d->send();
+    rxLength = quantity;
+    return quantity;
+}
+
+int TwoWire::available() { return rxLength - rxIndex; }
+int TwoWire::read() { return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1; }
+int TwoWire::peek() { return rxIndex < rxLength ? rxBuffer[rxIndex] : -1; }
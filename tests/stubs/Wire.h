@@ -0,0 +1,51 @@
+// Wire on the host talks to the HostI2CDevice list from Host.h
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include "Stream.h"
+
+#define BUFFER_LENGTH 32
+
+class TwoWire : public Stream {
+private:
+    uint8_t txAddress;
+    uint8_t txLength;
+    uint8_t rxBuffer[BUFFER_LENGTH];
+    uint8_t rxIndex;
+    uint8_t rxLength;
+public:
+    TwoWire();
+    void begin() {}
+    void begin(uint8_t address) {}
+    void begin(int address) {}
+    void setClock(uint32_t) {}
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(void) { return endTransmission(true); }
+    uint8_t endTransmission(uint8_t sendStop);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop) { return requestFrom(address, quantity); }
+    uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+    uint8_t requestFrom(int address, int quantity, int sendStop) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+    virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *data, size_t quantity);
+    size_t write(unsigned long n) { return write((uint8_t)n); }
+    size_t write(long n) { return write((uint8_t)n); }
+    size_t write(unsigned int n) { return write((uint8_t)n); }
+    size_t write(int n) { return write((uint8_t)n); }
+    using Print::write;
+    virtual int available(void);
+    virtual int read(void);
+    virtual int peek(void);
+    // Pre Arduino 1.0 names
+    void send(uint8_t data) { write(data); }
+    void send(int data) { write((uint8_t)data); }
+    void send(const uint8_t *data, uint8_t quantity) { write(data, quantity); }
+    uint8_t receive() { return read(); }
+    void onReceive(void (*)(int)) {}
+    void onRequest(void (*)(void)) {}
+};
+
+extern TwoWire Wire;
+
+#endif
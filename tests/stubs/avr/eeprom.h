@@ -0,0 +1,18 @@
+// EEPROM backed by a RAM image, see Host.h
+#ifndef _AVR_EEPROM_H_
+#define _AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+uint8_t eeprom_read_byte(const uint8_t *addr);
+uint16_t eeprom_read_word(const uint16_t *addr);
+uint32_t eeprom_read_dword(const uint32_t *addr);
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+void eeprom_write_word(uint16_t *addr, uint16_t value);
+void eeprom_write_dword(uint32_t *addr, uint32_t value);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_write_block(const void *src, void *dst, size_t n);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef _AVR_INTERRUPT_H_
+#define _AVR_INTERRUPT_H_
+#include <Arduino.h>
+#endif
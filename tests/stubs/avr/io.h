@@ -0,0 +1,142 @@
+// AVR I/O registers as plain variables. Writes to the PORT registers are
+// reported so an SPI device can follow its chip select line.
+#ifndef _AVR_IO_H_
+#define _AVR_IO_H_
+
+#include <stdint.h>
+
+class HostRegister {
+private:
+    uint8_t value;
+    char port;      // 'B' for PORTB, 0 for registers nobody watches
+    void set(uint8_t v);
+public:
+    HostRegister(char port = 0) : value(0), port(port) {}
+    operator uint8_t() const { return value; }
+    HostRegister &operator=(uint8_t v) { set(v); return *this; }
+    HostRegister &operator|=(uint8_t v) { set(value | v); return *this; }
+    HostRegister &operator&=(uint8_t v) { set(value & v); return *this; }
+    HostRegister &operator^=(uint8_t v) { set(value ^ v); return *this; }
+};
+
+// Called when a watched PORT register changes
+void HostPortWrite(char port, uint8_t before, uint8_t after);
+
+#define HOST_PORTS(X) X(A) X(B) X(C) X(D) X(E) X(F) X(G) X(H) X(J) X(K) X(L)
+#define HOST_DECLARE_PORT(p) extern HostRegister PORT##p, DDR##p, PIN##p;
+HOST_PORTS(HOST_DECLARE_PORT)
+#undef HOST_DECLARE_PORT
+
+extern HostRegister SREG, SPCR, SPSR, SPDR, ADCSRA, ADMUX, TWCR, TWBR, TWSR;
+extern HostRegister TCCR0A, TCCR0B, TCCR1A, TCCR1B, TCCR2A, TCCR2B, TCCR3A, TCCR3B, TCCR4A, TCCR4B, TCCR5A, TCCR5B;
+extern HostRegister OCR0A, OCR0B, OCR2A, OCR2B, TIMSK0, TIMSK1, TIMSK2, MCUSR, EICRA, EICRB, EIMSK, PCMSK0, PCMSK1, PCMSK2, PCICR, PCIFR;
+extern uint16_t OCR1A, OCR1B, OCR1C, OCR3A, OCR3B, OCR3C, OCR4A, OCR4B, OCR4C, OCR5A, OCR5B, OCR5C, ICR1, ICR3, ICR4, ICR5, TCNT1;
+
+#define SPIF 7
+#define SPE 6
+#define MSTR 4
+#define SPR0 0
+#define SPR1 1
+#define SPI2X 0
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define COM1A1 7
+#define COM1B1 5
+#define COM1C1 3
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WDRF 3
+
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define PE0 0
+#define PE1 1
+#define PE2 2
+#define PE3 3
+#define PE4 4
+#define PE5 5
+#define PE6 6
+#define PE7 7
+#define PF0 0
+#define PF1 1
+#define PF2 2
+#define PF3 3
+#define PF4 4
+#define PF5 5
+#define PF6 6
+#define PF7 7
+#define PG0 0
+#define PG1 1
+#define PG2 2
+#define PG3 3
+#define PG4 4
+#define PG5 5
+#define PG6 6
+#define PG7 7
+#define PH0 0
+#define PH1 1
+#define PH2 2
+#define PH3 3
+#define PH4 4
+#define PH5 5
+#define PH6 6
+#define PH7 7
+#define PJ0 0
+#define PJ1 1
+#define PJ2 2
+#define PJ3 3
+#define PJ4 4
+#define PJ5 5
+#define PJ6 6
+#define PJ7 7
+#define PK0 0
+#define PK1 1
+#define PK2 2
+#define PK3 3
+#define PK4 4
+#define PK5 5
+#define PK6 6
+#define PK7 7
+#define PL0 0
+#define PL1 1
+#define PL2 2
+#define PL3 3
+#define PL4 4
+#define PL5 5
+#define PL6 6
+#define PL7 7
+
+#endif
@@ -0,0 +1,42 @@
+// Flash and RAM are the same address space on the host
+#ifndef __PGMSPACE_H_
+#define __PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+typedef char prog_char;
+typedef uint8_t prog_uchar;
+typedef uint16_t prog_uint16_t;
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+#define pgm_read_byte_far(addr) pgm_read_byte(addr)
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_word_near(addr) pgm_read_word(addr)
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_float(addr) (*(const float *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcat_P strcat
+#define strncmp_P strncmp
+#define strcasecmp_P strcasecmp
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+// Counted, so a check can see how many comparisons a PROGMEM table lookup costs
+#ifdef __cplusplus
+extern "C"
+#endif
+int strcmp_P(const char *s1, const char *s2);
+
+#endif
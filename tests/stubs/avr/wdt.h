@@ -0,0 +1,14 @@
+#ifndef _AVR_WDT_H_
+#define _AVR_WDT_H_
+
+#define WDTO_15MS 0
+#define WDTO_1S 6
+#define WDTO_2S 7
+#define WDTO_4S 8
+#define WDTO_8S 9
+
+void wdt_reset();
+void wdt_enable(unsigned char timeout);
+void wdt_disable();
+
+#endif
@@ -0,0 +1,16 @@
+#include <avr/io.h>
+
+void HostRegister::set(uint8_t v)
+{
+    uint8_t before = value;
+    value = v;
+    if (port && before != v) HostPortWrite(port, before, v);
+}
+
+#define HOST_DEFINE_PORT(p) HostRegister PORT##p(#p[0]), DDR##p, PIN##p;
+HOST_PORTS(HOST_DEFINE_PORT)
+
+HostRegister SREG, SPCR, SPSR, SPDR, ADCSRA, ADMUX, TWCR, TWBR, TWSR;
+HostRegister TCCR0A, TCCR0B, TCCR1A, TCCR1B, TCCR2A, TCCR2B, TCCR3A, TCCR3B, TCCR4A, TCCR4B, TCCR5A, TCCR5B;
+HostRegister OCR0A, OCR0B, OCR2A, OCR2B, TIMSK0, TIMSK1, TIMSK2, MCUSR, EICRA, EICRB, EIMSK, PCMSK0, PCMSK1, PCMSK2, PCICR, PCIFR;
+uint16_t OCR1A, OCR1B, OCR1C, OCR3A, OCR3B, OCR3C, OCR4A, OCR4B, OCR4C, OCR5A, OCR5B, OCR5C, ICR1, ICR3, ICR4, ICR5, TCNT1;
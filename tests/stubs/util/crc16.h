@@ -0,0 +1,11 @@
+#ifndef _UTIL_CRC16_H_
+#define _UTIL_CRC16_H_
+#include <stdint.h>
+static inline uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data)
+{
+    crc = crc ^ data;
+    for (uint8_t i = 0; i < 8; i++)
+        crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : (crc >> 1);
+    return crc;
+}
+#endif
@@ -0,0 +1,6 @@
+#ifndef _UTIL_DELAY_H_
+#define _UTIL_DELAY_H_
+#include <Arduino.h>
+#define _delay_ms(ms) delay(ms)
+#define _delay_us(us) delayMicroseconds(us)
+#endif